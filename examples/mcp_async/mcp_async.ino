@@ -0,0 +1,65 @@
+/**
+   This sketch shows how to use the MCP23008 without blocking the loop (MCPAsync).
+   The reset sequence (15ms) and the I2C requests are queued. The loop calls async.poll() and keeps 
+   blinking the Arduino built in LED on time (it could be a UART or a motor control task).
+
+   Arduino and MCP23008 setup
+
+   | Device   | MCP23008 | Description |
+   | -------- | -------- | ----------- |
+   | Arduino  |          |             |
+   |    A5    |  SCL (1) | I2C Clock   |
+   |    A4    |  SDA (2) | I2C Data    |
+   |    D8    |  RESET   | Reset       |
+   | Buttons  |          |             |
+   |   SW0    |  GPIO 0  |             |
+   |   SW1    |  GPIO 1  |             |
+   |   SW2    |  GPIO 2  |             |
+   |   SW3    |  GPIO 3  |             |
+   | LEDs     |          |             |
+   |   LED4   |  GPIO 4  |             |
+   |   LED5   |  GPIO 5  |             |
+   |   LED6   |  GPIO 6  |             |
+   |   LED7   |  GPIO 7  |             |
+
+   Instructions:
+   Press the buttons (GPIO 0 ~ 3). The LED connected to GPIO (button + 4) follows the button.
+*/
+
+#include <pu2clr_mcp23008.h>
+#include <pu2clr_mcp23008_async.h>
+
+#define MCP_RESET_PIN 8
+
+MCP mcp;
+MCPAsync async(&mcp);
+
+volatile uint8_t configured = MCP_ASYNC_PENDING;
+uint8_t config[] = {0B00001111, 0, 0, 0, 0, 0, 0B00001111}; // IODIR ~ GPPU: GPIO 0 ~ 3 input with pull up; 4 ~ 7 output
+uint32_t lastBlink = 0;
+
+// Called when the GPIO read completes
+void onInputs(uint8_t status, const mcp23008_request *request) {
+  if (status != MCP_BUS_OK)
+    return;
+  async.setRegister(REG_OLAT, (uint8_t)((~request->value & 0x0F) << 4)); // buttons are active low
+}
+
+void setup() {
+  pinMode(LED_BUILTIN, OUTPUT);
+  mcp.setRegisterCache(true);
+  mcp.setup(0x20, 0B00001111);  // no reset here; it is done by the async reset below
+
+  async.reset(MCP_RESET_PIN);                                    // non-blocking reset sequence
+  async.writeRegisters(REG_IODIR, config, 7, 0, &configured);    // IODIR ~ GPPU in a single transaction after the reset
+}
+
+void loop() {
+  if (!async.poll() && configured == MCP_BUS_OK)
+    async.getRegister(REG_GPIO, onInputs);
+
+  if (millis() - lastBlink >= 100) {   // this task is never delayed by the MCP23008
+    lastBlink = millis();
+    digitalWrite(LED_BUILTIN, !digitalRead(LED_BUILTIN));
+  }
+}
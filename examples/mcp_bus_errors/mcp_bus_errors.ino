@@ -0,0 +1,78 @@
+/**
+   This sketch shows how to detect bus errors (long cables, EMI etc) and decide when to lower the I2C clock.
+   The configuration registers are read back after each write (verify-after-write) and the failed transfers are repeated.
+   Every second the sketch toggles the outputs, reads the inputs and shows the bus error counters.
+   If more than 5% of the transfers needed a retry, the I2C clock is lowered.
+
+   Arduino and MCP23008 setup
+
+   | Device   | MCP23008 | Description |
+   | -------- | -------- | ----------- |
+   | Arduino  |          |             |
+   |    A5    |  SCL (1) | I2C Clock   |
+   |    A4    |  SDA (2) | I2C Data    |
+   |   VCC    |  RESET   |             |
+   |   LEDs   |  GPIO 0 ~ 3 | outputs  |
+   | Switches |  GPIO 4 ~ 7 | inputs   |
+*/
+
+#include <pu2clr_mcp23008.h>
+
+MCP mcp;
+
+long i2cClock = 400000;
+uint16_t transfers = 0;
+uint8_t leds = 0B00000101;
+
+void setup() {
+  Serial.begin(9600); // The baudrate of Serial monitor is set in 9600
+  while (!Serial);
+
+  mcp.setup(0x20, 0B11110000, -1, i2cClock);   // GPIO 0 ~ 3 outputs; GPIO 4 ~ 7 inputs
+  mcp.setRetryPolicy(3, 200);               // up to 3 retries: 200us, 400us and 800us
+  mcp.setVerifyWrites(true);                // read back IODIR, IPOL, GPINTEN, DEFVAL, INTCON, IOCON and GPPU
+
+  if (mcp.writeRegister(REG_GPPU, 0B11110000) != MCP_BUS_OK)
+    Serial.println("The pull up resistors could not be configured!");
+  mcp.clearBusErrors();
+}
+
+void loop() {
+  uint8_t gpio;
+  mcp23008_bus_errors e;
+
+  leds ^= 0B00001111;
+  mcp.writeRegister(REG_GPIO, leds);
+  if (mcp.readRegister(REG_GPIO, &gpio) == MCP_BUS_OK) {
+    Serial.print("Inputs: ");
+    Serial.println(gpio >> 4, BIN);
+  } else {
+    Serial.print("Read error: ");
+    Serial.println(mcp.getLastError());
+  }
+  transfers += 2;
+
+  e = mcp.getBusErrors();
+  Serial.print("Errors (write/read/verify): ");
+  Serial.print(e.writeErrors);
+  Serial.print("/");
+  Serial.print(e.readErrors);
+  Serial.print("/");
+  Serial.print(e.verifyErrors);
+  Serial.print(" - retries: ");
+  Serial.print(e.retries);
+  Serial.print(" - failures: ");
+  Serial.println(e.failures);
+
+  if (transfers >= 100) {
+    if (e.retries * 20 > transfers && i2cClock > 100000) {
+      i2cClock /= 2;
+      mcp.getBus()->setClock(i2cClock);
+      Serial.print("Too many retries. I2C clock: ");
+      Serial.println(i2cClock);
+    }
+    mcp.clearBusErrors();
+    transfers = 0;
+  }
+  delay(1000);
+}
@@ -0,0 +1,64 @@
+/**
+   This sketch shows how to read two rotary (quadrature) encoders connected to the MCP23008 (MCPEncoder).
+   Each MCP23008 interrupt is serviced with a single 3 bytes I2C read (INTF, INTCAP and GPIO). 
+   The missed steps and overruns show when the I2C bus rate cannot keep up with the rotation speed.
+
+   Arduino and MCP23008 setup
+
+   | Device    | MCP23008 | Description |
+   | --------- | -------- | ----------- |
+   | Arduino   |          |             |
+   |    A5     |  SCL (1) | I2C Clock   |
+   |    A4     |  SDA (2) | I2C Data    |
+   |    D2     |  INT     | Interrupt   |
+   | Encoder 1 |          |             |
+   |    A      |  GPIO 0  |             |
+   |    B      |  GPIO 1  |             |
+   | Encoder 2 |          |             |
+   |    A      |  GPIO 2  |             |
+   |    B      |  GPIO 3  |             |
+   |   VCC     |  RESET   |             |
+
+   The common pin of the encoders goes to GND (internal pull up resistors are used).
+*/
+
+#include <pu2clr_mcp23008.h>
+#include <pu2clr_mcp23008_encoder.h>
+
+#define ARDUINO_INTERRUPT_PIN 2
+
+MCP mcp;
+MCPEncoder encoders(&mcp);
+
+void setup() {
+  Serial.begin(9600); // The baudrate of Serial monitor is set in 9600
+  while (!Serial);
+
+  mcp.setup(0x20, GPIO_INPUT, -1, 400000);  // all GPIO pins are input; 400kHz I2C bus
+  mcp.setInterrupt(INTERRUPT_INTPOL_ACTIVE_LOW, INTERRUPT_ODR_ACTIVE_DRIVE);
+  encoders.add(MCP_GPIO0, MCP_GPIO1);       // encoder 0
+  encoders.add(MCP_GPIO2, MCP_GPIO3);       // encoder 1
+
+  pinMode(ARDUINO_INTERRUPT_PIN, INPUT_PULLUP);
+  attachInterrupt(digitalPinToInterrupt(ARDUINO_INTERRUPT_PIN), checkMCP, FALLING);
+}
+
+/**
+   @brief ISR - just signals the event (no I2C traffic)
+*/
+void checkMCP() {
+  encoders.onInterrupt();
+}
+
+void loop() {
+  if (encoders.poll()) {
+    Serial.print("\nEncoder 0: ");
+    Serial.print(encoders.getPosition(0));
+    Serial.print(" | Encoder 1: ");
+    Serial.print(encoders.getPosition(1));
+    Serial.print(" | Missed: ");
+    Serial.print(encoders.getMissedSteps(0) + encoders.getMissedSteps(1));
+    Serial.print(" | Overruns: ");
+    Serial.print(encoders.getOverruns());
+  }
+}
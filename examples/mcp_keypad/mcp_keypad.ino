@@ -0,0 +1,63 @@
+/**
+   This sketch shows how to scan a 4x4 keypad matrix connected to the MCP23008 (MCPPinGroup).
+   Each row costs one I2C write (row low) and one I2C read (all columns), instead of one read per key.
+
+   Arduino and MCP23008 setup
+
+   | Device   | MCP23008 | Description |
+   | -------- | -------- | ----------- |
+   | Arduino  |          |             |
+   |    A5    |  SCL (1) | I2C Clock   |
+   |    A4    |  SDA (2) | I2C Data    |
+   | Keypad   |          |             |
+   |  Row 1   |  GPIO 0  | output      |
+   |  Row 2   |  GPIO 1  | output      |
+   |  Row 3   |  GPIO 2  | output      |
+   |  Row 4   |  GPIO 3  | output      |
+   |  Col 1   |  GPIO 4  | input       |
+   |  Col 2   |  GPIO 5  | input       |
+   |  Col 3   |  GPIO 6  | input       |
+   |  Col 4   |  GPIO 7  | input       |
+   |   VCC    |  RESET   |             |
+*/
+
+#include <pu2clr_mcp23008.h>
+#include <pu2clr_mcp23008_pingroup.h>
+
+const char keyMap[] = "123A456B789C*0#D";
+const uint8_t rowPins[] = {MCP_GPIO0, MCP_GPIO1, MCP_GPIO2, MCP_GPIO3};
+const uint8_t colPins[] = {MCP_GPIO4, MCP_GPIO5, MCP_GPIO6, MCP_GPIO7};
+
+MCP mcp;
+MCPPinGroup rows(&mcp);
+MCPPinGroup columns(&mcp);
+
+uint16_t lastKeys = 0;
+
+void setup() {
+  Serial.begin(9600); // The baudrate of Serial monitor is set in 9600
+  while (!Serial);
+
+  mcp.setup(0x20, GPIO_INPUT);
+  mcp.setRegisterCache(true);   // the OLAT value comes from the shadow register
+  rows.setup(rowPins, 4, true);
+  columns.setup(colPins, 4, false);  // inputs with the internal pull up resistors
+  rows.setupKeypad(&columns);   // 4 x 4 = 16 keys (the maximum)
+  mcp.beginGpioStream();        // the column reads are bare reads (no register address)
+
+  Serial.print("\n**** Please, press any key  ****\n");
+}
+
+void loop() {
+  uint16_t keys = rows.scanKeypad();
+  uint16_t pressed = keys & ~lastKeys;
+
+  for (uint8_t k = 0; k < 16; k++) {
+    if (pressed & (1 << k)) {
+      Serial.print("\nKey: ");
+      Serial.print(keyMap[k]);
+    }
+  }
+  lastKeys = keys;
+  delay(20);
+}
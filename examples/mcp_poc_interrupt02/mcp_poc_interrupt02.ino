@@ -49,6 +49,10 @@ void setup() {
 
     mcp.setup(0x20, 255); // I2C address = 0x20 and all MCP23008 GPIO pins are configured as input
     
+    // The changes below are staged and sent to the device by commit. beginBatch first reads the current registers into the register cache.
+    // commit writes IOCON first and then GPINTEN to GPPU in one sequential write: two I2C writes instead of one per setRegister.
+    mcp.beginBatch();
+
     iocon = mcp.getRegister(REG_IOCON); 
     iocon |= 0B00000110;
     mcp.setRegister(REG_IOCON,iocon);
@@ -58,6 +62,8 @@ void setup() {
     mcp.setRegister(REG_DEFVAL,0B00001111);  // The pins 0,1,2 and 3 will be compared with 1. If it one of them was not equal to 1, than an interrupt will occur;
     mcp.setRegister(REG_INTCON,0); // Pin value is compared against the previous pin value.
 
+    mcp.commit();
+
     Serial.print("\n**** Make pins 0, 1, 2 or 3 low ****\n");  
 }
 
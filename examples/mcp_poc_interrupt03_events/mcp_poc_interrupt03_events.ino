@@ -0,0 +1,79 @@
+/**
+   This sketch shows how to deal with interrupts by using the event queue (MCPEventQueue).
+   The ISR does not use the I2C bus. It just signals the interrupt. In the loop, pollEvents reads INTF and INTCAP 
+   in a single I2C transaction, queues the event and calls the handler of each pin that caused the interrupt.
+
+   See schematic on https://github.com/pu2clr/MCP23008#internal-interrupt-setup
+
+   Arduino and MCP23008 setup
+
+   | Device   | MCP23008 | Description |
+   | -------- | -------- | ----------- |
+   | Arduino  |          |             |
+   |    A5    |  SCL (1) | I2C Clock   |
+   |    A4    |  SDA (2) | I2C Data    |
+   |    D2    |  INT     | Interrupt   |
+   | Buttons  |          |             |
+   |   SW0    |  GPIO 0  |             |
+   |   SW1    |  GPIO 1  |             |
+   |   SW2    |  GPIO 2  |             |
+   |   SW3    |  GPIO 3  |             |
+   |   VCC    |  RESET   |             |
+
+   Instructions:
+   When the system starts, press any button and check the Serial Monitor.
+*/
+
+#include <pu2clr_mcp23008.h>
+#include <pu2clr_mcp23008_events.h>
+
+#define ARDUINO_INTERRUPT_PIN 2
+
+MCP mcp;
+MCPEventQueue events(&mcp);
+
+void setup() {
+  Serial.begin(9600); // The baudrate of Serial monitor is set in 9600
+  while (!Serial);
+
+  mcp.setRegisterCache(true);   // the configuration registers are served from the shadow registers
+  mcp.setup(0x20, GPIO_INPUT);  // all GPIO pins are input
+  mcp.setInterrupt(INTERRUPT_INTPOL_ACTIVE_LOW, INTERRUPT_ODR_ACTIVE_DRIVE);
+
+  mcp.beginBatch();
+  mcp.setRegister(REG_GPPU, 0B00001111);    // Enables the pull up resistors on pins 0,1,2,3
+  mcp.setRegister(REG_GPINTEN, 0B00001111); // The pins 0,1,2 and 3 launch interrupts
+  mcp.setRegister(REG_INTCON, 0);           // Pin value is compared against the previous pin value (press and release)
+  mcp.commit();
+
+  for (uint8_t gpio = MCP_GPIO0; gpio <= MCP_GPIO3; gpio++)
+    events.attach(gpio, onButton);
+
+  pinMode(ARDUINO_INTERRUPT_PIN, INPUT_PULLUP);
+  attachInterrupt(digitalPinToInterrupt(ARDUINO_INTERRUPT_PIN), checkMCP, FALLING);
+  mcp.getINTCAP(); // clears any pending interrupt
+
+  Serial.print("\n**** Please, press the buttons 0, 1, 2 or 3  ****\n");
+}
+
+/**
+   @brief ISR - just signals the event (no I2C traffic)
+*/
+void checkMCP() {
+  events.onInterrupt();
+}
+
+/**
+   @brief Button handler. Called by pollEvents.
+*/
+void onButton(uint8_t gpio, bool level, const mcp23008_event *event) {
+  Serial.print("\nButton: ");
+  Serial.print(gpio);
+  Serial.print((level) ? " released" : " pressed");
+  Serial.print(" at (us): ");
+  Serial.print(event->timestamp);
+}
+
+void loop() {
+  events.pollEvents();
+}
@@ -0,0 +1,72 @@
+/**
+   This sketch shows how to read buttons without debounce loops (MCPDebouncer).
+   While the buttons are quiet, there is no I2C traffic. When the MCP23008 INT fires, a few timed GPIO reads 
+   confirm the new state. Press, release and long-press events of all pins are reported as bit masks.
+
+   See schematic on https://github.com/pu2clr/MCP23008#internal-interrupt-setup
+
+   Arduino and MCP23008 setup
+
+   | Device   | MCP23008 | Description |
+   | -------- | -------- | ----------- |
+   | Arduino  |          |             |
+   |    A5    |  SCL (1) | I2C Clock   |
+   |    A4    |  SDA (2) | I2C Data    |
+   |    D2    |  INT     | Interrupt   |
+   | Buttons  |          |             |
+   |   SW0    |  GPIO 0  |             |
+   |   SW1    |  GPIO 1  |             |
+   |   SW2    |  GPIO 2  |             |
+   |   SW3    |  GPIO 3  |             |
+   |   VCC    |  RESET   |             |
+
+   Instructions:
+   When the system starts, press (or hold) any button and check the Serial Monitor.
+*/
+
+#include <pu2clr_mcp23008.h>
+#include <pu2clr_mcp23008_debounce.h>
+
+#define ARDUINO_INTERRUPT_PIN 2
+
+MCP mcp;
+MCPDebouncer buttons(&mcp);
+
+void setup() {
+  Serial.begin(9600); // The baudrate of Serial monitor is set in 9600
+  while (!Serial);
+
+  mcp.setup(0x20, GPIO_INPUT);  // all GPIO pins are input
+  mcp.setInterrupt(INTERRUPT_INTPOL_ACTIVE_LOW, INTERRUPT_ODR_ACTIVE_DRIVE);
+  buttons.setup(0B00001111);    // GPIO 0 ~ 3: buttons to GND, internal pull up resistors
+
+  pinMode(ARDUINO_INTERRUPT_PIN, INPUT_PULLUP);
+  attachInterrupt(digitalPinToInterrupt(ARDUINO_INTERRUPT_PIN), checkMCP, FALLING);
+
+  Serial.print("\n**** Please, press the buttons 0, 1, 2 or 3  ****\n");
+}
+
+/**
+   @brief ISR - just signals the event (no I2C traffic)
+*/
+void checkMCP() {
+  buttons.onInterrupt();
+}
+
+void showPins(const char *event, uint8_t pins) {
+  for (uint8_t gpio = 0; gpio < 8; gpio++) {
+    if (pins & (1 << gpio)) {
+      Serial.print("\nButton: ");
+      Serial.print(gpio);
+      Serial.print(event);
+    }
+  }
+}
+
+void loop() {
+  if (buttons.update()) {
+    showPins(" pressed", buttons.getPressed());
+    showPins(" released", buttons.getReleased());
+    showPins(" long press", buttons.getLongPressed());
+  }
+}
@@ -0,0 +1,65 @@
+/**
+   This sketch shows how to switch the MCP23008 between two configurations (profiles) with MCPConfig.
+   Only the registers that are different are written (sequential bursts over contiguous registers).
+   Every 5 seconds the device goes from "inputCapture" (all inputs, pull up, interrupt-on-change)
+   to "outputDrive" (all outputs) and back.
+
+   Arduino and MCP23008 setup
+
+   | Device   | MCP23008 | Description |
+   | -------- | -------- | ----------- |
+   | Arduino  |          |             |
+   |    A5    |  SCL (1) | I2C Clock   |
+   |    A4    |  SDA (2) | I2C Data    |
+   |   VCC    |  RESET   |             |
+*/
+
+#include <pu2clr_mcp23008.h>
+#include <pu2clr_mcp23008_config.h>
+
+//                       IODIR IPOL GPINTEN DEFVAL INTCON IOCON GPPU  OLAT
+MCPConfig inputCapture(  0xFF, 0,   0xFF,   0,     0,     0,    0xFF, 0);
+MCPConfig outputDrive(   0x00, 0,   0,      0,     0,     0,    0,    0B10100101);
+
+MCP mcp;
+MCPConfig saved;
+bool outputs = false;
+
+void showConfig(const char *name, MCPConfig *config) {
+  Serial.print(name);
+  for (uint8_t reg = REG_IODIR; reg <= REG_OLAT; reg++) {
+    if (reg == REG_INTF || reg == REG_INTCAP || reg == REG_GPIO) continue;
+    Serial.print(" ");
+    Serial.print(config->getRegister(reg), HEX);
+  }
+  Serial.println();
+}
+
+void setup() {
+  Serial.begin(9600); // The baudrate of Serial monitor is set in 9600
+  while (!Serial);
+
+  mcp.setup(0x20, GPIO_INPUT);
+  saved.capture(&mcp);          // the configuration after setup
+  showConfig("Saved:", &saved);
+  mcp.setRegisterCache(true);   // apply compares with the shadow registers (no reads)
+  inputCapture.apply(&mcp);
+}
+
+void loop() {
+  MCPConfig current;
+
+  delay(5000);
+  outputs = !outputs;
+  if (outputs) {
+    Serial.print("outputDrive - changed registers: ");
+    Serial.println(outputDrive.diff(inputCapture), BIN);
+    outputDrive.apply(&mcp);
+  } else {
+    Serial.print("inputCapture - changed registers: ");
+    Serial.println(inputCapture.diff(outputDrive), BIN);
+    inputCapture.apply(&mcp);
+  }
+  current.capture(&mcp);
+  showConfig("Device:", &current);
+}
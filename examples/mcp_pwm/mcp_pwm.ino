@@ -0,0 +1,59 @@
+/**
+   This sketch shows how to dim LEDs connected to the MCP23008 outputs (MCPPwm - software PWM).
+   Each PWM period is a precomputed list of OLAT writes (one write per distinct duty cycle). 
+   The Serial Monitor shows the maximum PWM frequency for the I2C clock used.
+
+   Arduino and MCP23008 setup
+
+   | Device   | MCP23008 | Description |
+   | -------- | -------- | ----------- |
+   | Arduino  |          |             |
+   |    A5    |  SCL (1) | I2C Clock   |
+   |    A4    |  SDA (2) | I2C Data    |
+   | LEDs     |          |             |
+   |   LED0   |  GPIO 0  |             |
+   |   LED1   |  GPIO 1  |             |
+   |   LED2   |  GPIO 2  |             |
+   |   LED3   |  GPIO 3  |             |
+   |   VCC    |  RESET   |             |
+*/
+
+#include <pu2clr_mcp23008.h>
+#include <pu2clr_mcp23008_pwm.h>
+
+#define I2C_CLOCK 400000
+#define PWM_FREQUENCY 200
+#define PWM_STEPS 32
+
+MCP mcp;
+MCPPwm pwm(&mcp);
+
+uint32_t lastChange = 0;
+uint8_t level = 0;
+
+void setup() {
+  Serial.begin(9600); // The baudrate of Serial monitor is set in 9600
+  while (!Serial);
+
+  mcp.setup(0x20, GPIO_OUTPUT, -1, I2C_CLOCK);
+  pwm.setup(0B00001111, PWM_FREQUENCY, PWM_STEPS);
+
+  Serial.print("\nMaximum PWM frequency with ");
+  Serial.print(PWM_STEPS);
+  Serial.print(" steps: ");
+  Serial.print(MCPPwm::getMaxFrequency(I2C_CLOCK, PWM_STEPS));
+  Serial.print("Hz");
+}
+
+void loop() {
+  pwm.update();
+
+  if (millis() - lastChange >= 50) {  // fading effect
+    lastChange = millis();
+    level = (level + 1) % (PWM_STEPS + 1);
+    pwm.setDuty(MCP_GPIO0, level);
+    pwm.setDuty(MCP_GPIO1, PWM_STEPS - level);
+    pwm.setDuty(MCP_GPIO2, PWM_STEPS / 4);
+    pwm.setDuty(MCP_GPIO3, PWM_STEPS / 2);
+  }
+}
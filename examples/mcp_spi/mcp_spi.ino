@@ -0,0 +1,49 @@
+/**
+   This sketch shows how to control two MCP23S08 (SPI version of the MCP23008) sharing one chip select.
+   The first device (A1 A0 = 00) drives 8 LEDs and the second one (A1 A0 = 01) reads 8 switches.
+   The LEDs show the switches. The library API is the same used with the MCP23008 (I2C).
+
+   Arduino and MCP23S08 setup
+
+   | Device     | MCP23S08    | Description         |
+   | ---------- | ----------- | ------------------- |
+   | Arduino    |             |                     |
+   |    D13     |  SCK (1)    | SPI Clock           |
+   |    D11     |  SI  (2)    | MOSI                |
+   |    D12     |  SO  (3)    | MISO                |
+   |    D10     |  CS  (7)    | Chip select (both)  |
+   |   VCC      |  RESET (6)  |                     |
+   | MCP23S08 #1|  A1, A0     | GND, GND (0x20)     |
+   | MCP23S08 #2|  A1, A0     | GND, VCC (0x21)     |
+*/
+
+#include <pu2clr_mcp23008.h>
+#include <pu2clr_mcp23008_spi.h>
+
+MCPArduinoSpiPort port(10);   // chip select on Arduino pin 10
+MCPSpiBus spiBus(&port);
+MCP leds;
+MCP switches;
+
+void setup() {
+  Serial.begin(9600); // The baudrate of Serial monitor is set in 9600
+  while (!Serial);
+
+  spiBus.enableHardwareAddress();                   // both devices answer only to their own A1 A0 from now on
+
+  leds.setBus(&spiBus);
+  leds.setup(0x20, GPIO_OUTPUT, -1, 10000000);      // SPI clock: 10MHz
+  switches.setBus(&spiBus);
+  switches.setup(0x21, GPIO_INPUT, -1, 10000000);
+  switches.setRegister(REG_GPPU, 0xFF);             // internal pull up resistors
+
+  if (spiBus.probe(0x21) != MCP_BUS_OK)
+    Serial.println("MCP23S08 #2 not found!");
+}
+
+void loop() {
+  uint8_t value = switches.getGPIOS();
+  leds.setGPIOS(~value);                            // a closed switch (0) turns the LED on
+  Serial.println(value, BIN);
+  delay(200);
+}
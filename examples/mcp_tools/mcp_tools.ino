@@ -45,12 +45,15 @@ void setup()
 
 void showAllRegisters()
 {
+    uint8_t regs[MCP_REG_COUNT];
+
     Serial.print("\n********************\nCurrent register values\n");
+    mcp.readRegisters(REG_IODIR, regs, MCP_REG_COUNT); // All registers in one I2C transaction
     for (uint8_t reg = REG_IODIR; reg <= REG_OLAT; reg++)
     {
         sprintf(buffer, "\nRegister 0x%X = ", reg);
         Serial.print(buffer);
-        Serial.print(mcp.getRegister(reg), BIN);
+        Serial.print(regs[reg], BIN);
     }
 }
 
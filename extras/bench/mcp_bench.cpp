@@ -0,0 +1,157 @@
+/**
+ * @file mcp_bench.cpp
+ * @brief Bus cost of the MCP API (transactions per operation) - host benchmark
+ * @details Runs the main MCP functions against a simulated MCP23008 (MCPSimulatedBus) measured by MCPBusMonitor. No device is needed.
+ * @details For each operation it shows the I2C transactions, the bytes on the wire and the modeled bus time at 100KHz, 400KHz and 1.7MHz.
+ * @details Each operation has a maximum number of transactions. If a change in the library adds bus round trips, the operation is 
+ * @details reported as FAIL and the program exits with 1 (the ctest "mcp_bench" test fails).
+ * @details The maximums are the current transaction counts, with no tolerance: any extra transaction fails. Lower them when an operation gets cheaper.
+ * @code
+ *   cmake -S . -B build
+ *   cmake --build build
+ *   ./build/mcp_bench
+ * @endcode
+ */
+
+#include <stdio.h>
+#include "pu2clr_mcp23008.h"
+#include "pu2clr_mcp23008_sim.h"
+#include "pu2clr_mcp23008_monitor.h"
+
+#define MODE_DEFAULT 0 // no register cache
+#define MODE_CACHE 1   // register cache (setRegisterCache)
+#define MODE_ELISION 2 // register cache + write elision (setWriteElision)
+
+typedef struct
+{
+  const char *name;
+  uint8_t mode;
+  void (*run)(MCP *mcp);
+  uint16_t maxTransactions;  // regression threshold
+} Bench;
+
+void benchTurnGpioOn(MCP *mcp) { mcp->turnGpioOn(MCP_GPIO3); }
+void benchTurnGpioOnTwice(MCP *mcp) { mcp->turnGpioOn(MCP_GPIO3); mcp->turnGpioOn(MCP_GPIO3); }
+void benchGpioWrite(MCP *mcp) { mcp->gpioWrite(MCP_GPIO5, HIGH); }
+void benchGpioRead(MCP *mcp) { mcp->gpioRead(MCP_GPIO5); }
+void benchInterruptGpioOn(MCP *mcp) { mcp->interruptGpioOn(MCP_GPIO1, HIGH); }
+void benchLookForDevice(MCP *mcp) { mcp->lookForDevice(); }  // the simulated device is at 0x27 (worst case)
+
+void benchDumpOneByOne(MCP *mcp) {
+  for (uint8_t reg = REG_IODIR; reg <= REG_OLAT; reg++)
+    mcp->getRegister(reg);
+}
+
+void benchDumpBurst(MCP *mcp) {
+  uint8_t regs[MCP_REG_COUNT];
+  mcp->readRegisters(REG_IODIR, regs, MCP_REG_COUNT);
+}
+
+void benchMultiPin(MCP *mcp) {
+  mcp->turnGpioOn(MCP_GPIO0);
+  mcp->turnGpioOn(MCP_GPIO2);
+  mcp->turnGpioOff(MCP_GPIO4);
+  mcp->turnGpioOn(MCP_GPIO6);
+}
+
+void benchMultiPinBatch(MCP *mcp) {
+  mcp->beginBatch();
+  benchMultiPin(mcp);
+  mcp->commit();
+}
+
+void benchInterruptSetupBatch(MCP *mcp) {
+  mcp->beginBatch();
+  mcp->setRegister(REG_GPPU, 0B00001111);
+  mcp->setRegister(REG_GPINTEN, 0B00001111);
+  mcp->setRegister(REG_DEFVAL, 0B00001111);
+  mcp->setRegister(REG_INTCON, 0);
+  mcp->commit();
+}
+
+void benchInterruptCapture(MCP *mcp) {
+  uint8_t intf, intcap;
+  mcp->getInterruptCapture(&intf, &intcap);
+}
+
+void benchGpioStream(MCP *mcp) {
+  uint8_t samples[16];
+  mcp->readGpioSamples(samples, 16);
+}
+
+void benchGpioStreamParked(MCP *mcp) {
+  mcp->beginGpioStream();
+  benchGpioStream(mcp);
+}
+
+const Bench benches[] = {
+    {"turnGpioOn", MODE_DEFAULT, benchTurnGpioOn, 2},
+    {"turnGpioOn (cache)", MODE_CACHE, benchTurnGpioOn, 1},
+    {"turnGpioOn x2 (elision)", MODE_ELISION, benchTurnGpioOnTwice, 1},
+    {"gpioWrite", MODE_DEFAULT, benchGpioWrite, 2},
+    {"gpioWrite (cache)", MODE_CACHE, benchGpioWrite, 1},
+    {"gpioRead", MODE_DEFAULT, benchGpioRead, 1},
+    {"interruptGpioOn", MODE_DEFAULT, benchInterruptGpioOn, 6},
+    {"interruptGpioOn (cache)", MODE_CACHE, benchInterruptGpioOn, 3},
+    {"lookForDevice (0x27)", MODE_DEFAULT, benchLookForDevice, 8},
+    {"register dump 1 by 1", MODE_DEFAULT, benchDumpOneByOne, 11},
+    {"register dump (burst)", MODE_DEFAULT, benchDumpBurst, 2},
+    {"register dump (burst/cache)", MODE_CACHE, benchDumpBurst, 1},
+    {"4 pins", MODE_DEFAULT, benchMultiPin, 8},
+    {"4 pins (cache)", MODE_CACHE, benchMultiPin, 4},
+    {"4 pins (batch)", MODE_CACHE, benchMultiPinBatch, 1},
+    {"interrupt setup (batch)", MODE_CACHE, benchInterruptSetupBatch, 1},
+    {"interrupt capture", MODE_DEFAULT, benchInterruptCapture, 1},
+    {"16 GPIO samples", MODE_DEFAULT, benchGpioStream, 16},
+    {"16 GPIO samples (stream)", MODE_CACHE, benchGpioStreamParked, 3},
+};
+
+MCPSimDevice chip;
+MCPSimulatedBus simBus;
+MCPBusMonitor monitor(&simBus);
+
+/**
+ * @brief Runs one operation on a fresh device and returns true if it is within its threshold
+ */
+bool runBench(const Bench *b) {
+  MCP mcp;
+
+  chip.reset();
+  mcp.setBus(&monitor);
+  if (b->mode == MODE_CACHE)
+    mcp.setRegisterCache(true);
+  else if (b->mode == MODE_ELISION)
+    mcp.setWriteElision(true);
+  mcp.setup(0x27, 0B00001111);
+
+  monitor.resetStats();
+  b->run(&mcp);
+
+  const mcp23008_bus_stats *stats = monitor.getStats();
+  bool pass = stats->transactions <= b->maxTransactions;
+  printf("%-28s %4lu %4lu %4lu %7lu %7lu %7lu  %s\n", b->name,
+         (unsigned long)stats->transactions, (unsigned long)b->maxTransactions,
+         (unsigned long)(stats->bytesWritten + stats->bytesRead),
+         (unsigned long)monitor.getBusTime(100000), (unsigned long)monitor.getBusTime(400000),
+         (unsigned long)monitor.getBusTime(1700000), (pass) ? "PASS" : "FAIL");
+  return pass;
+}
+
+int main() {
+  unsigned failures = 0;
+
+  simBus.attach(0x27, &chip);
+
+  printf("Operation                      Tx  Max Byte  100KHz  400KHz  1.7MHz (us)\n");
+  for (uint8_t i = 0; i < sizeof(benches) / sizeof(Bench); i++)
+    if (!runBench(&benches[i]))
+      failures++;
+
+  if (failures)
+  {
+    printf("\nREGRESSION: %u operation(s) above the maximum number of transactions\n", failures);
+    return 1;
+  }
+  printf("\nAll operations within the expected bus cost\n");
+  return 0;
+}
@@ -0,0 +1,56 @@
+/**
+ * @file mcp_test.h
+ * @brief Minimal test support for the host tests (extras/tests)
+ * @details CHECK does not depend on assert, so the tests also run in release (NDEBUG) builds.
+ * @details CountBus is a simulated bus that counts the I2C transactions.
+ */
+
+#ifndef _MCP_TEST_H
+#define _MCP_TEST_H
+
+#include <stdio.h>
+#include "pu2clr_mcp23008_sim.h"
+
+static int mcpTestFailures = 0;
+
+#define CHECK(condition)                                                    \
+   do                                                                       \
+   {                                                                        \
+      if (!(condition))                                                     \
+      {                                                                     \
+         fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+         mcpTestFailures++;                                                 \
+      }                                                                     \
+   } while (0)
+
+#define TEST_RESULT() (mcpTestFailures == 0 ? (puts("ok"), 0) : 1)
+
+/**
+ * @brief Simulated bus that counts write and read transactions
+ */
+class CountBus : public MCPSimulatedBus
+{
+public:
+   int writes = 0;
+   int reads = 0;
+
+   uint8_t writeRegisters(uint8_t address, uint8_t reg, const uint8_t *data, uint8_t n)
+   {
+      this->writes++;
+      return MCPSimulatedBus::writeRegisters(address, reg, data, n);
+   }
+   uint8_t readRegisters(uint8_t address, uint8_t reg, uint8_t *data, uint8_t n)
+   {
+      this->reads++;
+      return MCPSimulatedBus::readRegisters(address, reg, data, n);
+   }
+   uint8_t readCurrent(uint8_t address, uint8_t *data, uint8_t n)
+   {
+      this->reads++;
+      return MCPSimulatedBus::readCurrent(address, data, n);
+   }
+   inline int transactions() { return this->writes + this->reads; }
+   inline void reset() { this->writes = this->reads = 0; }
+};
+
+#endif // _MCP_TEST_H
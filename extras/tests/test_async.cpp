@@ -0,0 +1,84 @@
+/**
+ * @file test_async.cpp
+ * @brief Asynchronous requests: one transaction per single register request and caller progress on a slow transport
+ */
+
+#include "mcp_test.h"
+#include "pu2clr_mcp23008_async.h"
+
+static uint8_t lastValue = 0;
+
+/**
+ * @brief Transport that reports busy when told to (a background transfer in progress)
+ */
+class BusyBus : public CountBus
+{
+public:
+   bool busy = false;
+
+   bool isBusy() { return this->busy; }
+};
+
+static void onRead(uint8_t status, const mcp23008_request *request)
+{
+   if (status == MCP_BUS_OK)
+      lastValue = request->value;
+}
+
+int main()
+{
+   MCPSimDevice chip;
+   BusyBus bus;
+   MCP mcp;
+   MCPAsync async(&mcp);
+   volatile uint8_t status;
+   uint8_t regs[3];
+
+   bus.attach(0x20, &chip);
+   mcp.setBus(&bus);
+   mcp.setup(0x20, 0x0F);   // register cache disabled
+   chip.setInputs(0x05);
+
+   // single register requests: one transaction each (no IOCON access)
+   bus.reset();
+   CHECK(async.getRegister(REG_GPIO, onRead, &status));
+   CHECK(status == MCP_ASYNC_PENDING);
+   while (async.poll())
+      ;
+   CHECK(status == MCP_BUS_OK && lastValue == 0x05);
+   CHECK(bus.transactions() == 1);
+
+   bus.reset();
+   CHECK(async.setRegister(REG_GPPU, 0x0F, 0, &status));
+   while (async.poll())
+      ;
+   CHECK(status == MCP_BUS_OK && chip.peek(REG_GPPU) == 0x0F);
+   CHECK(bus.transactions() == 1);
+
+   // failed single register request: the bus status is reported
+   bus.injectErrors(1, MCP_BUS_NACK_ADDRESS);
+   CHECK(async.getRegister(REG_GPIO, 0, &status));
+   while (async.poll())
+      ;
+   CHECK(status == MCP_BUS_NACK_ADDRESS);
+
+   // slow transport: poll returns at once while the bus is busy and the caller keeps running
+   CHECK(async.setRegister(REG_OLAT, 0x30));
+   CHECK(async.readRegisters(REG_IOCON, regs, 3, 0, &status));
+   uint32_t loops = 0, waited = 0;
+   while (!async.isIdle())
+   {
+      bus.busy = (loops % 4) != 3;   // the transport is free one poll in four
+      int before = bus.transactions();
+      async.poll();
+      if (bus.busy && bus.transactions() != before)
+         waited++;   // the bus was busy and poll still made a transfer
+      loops++;
+   }
+   CHECK(status == MCP_BUS_OK && regs[REG_GPPU - REG_IOCON] == 0x0F);
+   CHECK(chip.peek(REG_OLAT) == 0x30);
+   CHECK(loops >= 8);       // the caller made progress between the transfers
+   CHECK(waited == 0);      // no poll call waited for the bus
+
+   return TEST_RESULT();
+}
@@ -0,0 +1,56 @@
+/**
+ * @file test_bank.cpp
+ * @brief MCPBank: bank-wide writes reach the right device with one transaction per changed device
+ */
+
+#include "mcp_test.h"
+#include "pu2clr_mcp23008_bank.h"
+
+int main()
+{
+   MCPSimDevice chips[3];
+   CountBus bus;
+   MCPBank bank;
+
+   for (uint8_t i = 0; i < 3; i++)
+      bus.attach(0x20 + i, &chips[i]);
+   bank.setup(3, GPIO_OUTPUT, 0x20, &bus);
+   CHECK(bank.getCount() == 3);
+   for (uint8_t i = 0; i < 3; i++)
+      CHECK(chips[i].peek(REG_IODIR) == 0 && chips[i].peek(REG_OLAT) == 0);
+
+   // pin n belongs to device n / 8; one write per pin change; nothing sent when the level does not change
+   bus.reset();
+   bank.pinWrite(10, HIGH);
+   CHECK(chips[0].peek(REG_OLAT) == 0 && chips[1].peek(REG_OLAT) == 0x04 && chips[2].peek(REG_OLAT) == 0);
+   CHECK(bus.writes == 1 && bus.reads == 0);
+   bank.pinWrite(10, HIGH);
+   CHECK(bus.transactions() == 1);
+   bank.pinWrite(23, HIGH);
+   CHECK(chips[2].peek(REG_OLAT) == 0x80 && bus.writes == 2);
+   bank.pinWrite(64, HIGH);
+   CHECK(bus.transactions() == 2);
+
+   // masked writes: only the devices whose bits changed are written (one transaction each)
+   bus.reset();
+   bank.writeMasked(0x0000FF0000FFULL, 0x0000FF0000FFULL);
+   CHECK(chips[0].peek(REG_OLAT) == 0xFF && chips[1].peek(REG_OLAT) == 0x04 && chips[2].peek(REG_OLAT) == 0x80);
+   CHECK(bus.writes == 1 && bus.reads == 0);
+   bus.reset();
+   bank.writeAll(0x0180FFULL);
+   CHECK(chips[0].peek(REG_OLAT) == 0xFF && chips[1].peek(REG_OLAT) == 0x80 && chips[2].peek(REG_OLAT) == 0x01);
+   CHECK(bus.writes == 2);
+   CHECK(bank.getOutputs() == 0x0180FFULL && bus.reads == 0);
+
+   // direction and reads: one GPIO read per device
+   bus.reset();
+   bank.setDirection(0x00FF00ULL);
+   CHECK(chips[1].peek(REG_IODIR) == 0xFF && bus.writes == 1);
+   chips[1].setInputs(0x5A);
+   bus.reset();
+   CHECK(bank.readAll() == 0x015AFFULL);
+   CHECK(bus.reads == 3 && bus.writes == 0);
+   CHECK(bank.pinRead(9) && !bank.pinRead(8) && !bank.pinRead(40));
+
+   return TEST_RESULT();
+}
@@ -0,0 +1,92 @@
+/**
+ * @file test_batch.cpp
+ * @brief Batches (beginBatch / commit) are atomic: reads inside a batch do not flush it; known IOCON is not read again; loading the cache keeps a pending interrupt
+ */
+
+#include "mcp_test.h"
+
+int main()
+{
+   MCPSimDevice chip;
+   CountBus bus;
+   MCP mcp;
+   uint8_t regs[MCP_REG_COUNT];
+   uint8_t intf, intcap;
+   uint8_t wave[] = {0x01, 0x00};
+
+   bus.attach(0x20, &chip);
+   mcp.setBus(&bus);
+   mcp.setup(0x20, 0x0F);
+
+   // configuration reads inside a batch come from the staged values; nothing reaches the device before commit
+   chip.setInputs(0x0F);
+   mcp.beginBatch();
+   mcp.setRegister(REG_GPPU, 0x0F);
+   mcp.setRegister(REG_INTCON, 0);
+   mcp.setRegister(REG_GPINTEN, 0x0F);
+   bus.reset();
+   CHECK(mcp.readRegisters(REG_IODIR, regs, MCP_REG_COUNT) == MCP_REG_COUNT);
+   CHECK(regs[REG_GPPU] == 0x0F && regs[REG_GPINTEN] == 0x0F && regs[REG_GPIO] == 0x0F);
+   CHECK(bus.writes == 0 && bus.reads == 3);  // INTF, INTCAP and GPIO
+   CHECK(mcp.getInterruptCapture(&intf, &intcap));
+   CHECK(bus.writes == 0);
+   CHECK(mcp.writeRepeated(REG_GPIO, wave, sizeof(wave)) == 0);
+   CHECK(!mcp.beginGpioStream());
+   CHECK(chip.peek(REG_GPPU) == 0 && chip.peek(REG_GPINTEN) == 0);
+   CHECK(mcp.isBatching());
+
+   bus.reset();
+   CHECK(mcp.commit());
+   CHECK(bus.writes == 1);                    // GPINTEN ~ GPPU in one burst
+   CHECK(chip.peek(REG_GPPU) == 0x0F && chip.peek(REG_GPINTEN) == 0x0F);
+   CHECK(mcp.beginGpioStream());
+   mcp.endGpioStream();
+
+   // a read outside a batch does not overwrite a dirty register: the next flush still writes the staged value
+   mcp.setRegister(REG_GPPU, 0x0F);
+   chip.writeRegister(REG_GPPU, 0);           // the device lost the value (Example: a failed write)
+   mcp.markDirty(1 << REG_GPPU);
+   CHECK(mcp.readRegisters(REG_IODIR, regs, REG_GPPU + 1) == REG_GPPU + 1);
+   CHECK(regs[REG_GPPU] == 0);                // the caller gets the device value
+   CHECK(mcp.flush());
+   CHECK(chip.peek(REG_GPPU) == 0x0F);
+
+   // cache disabled: IOCON is read from the device only while its value is not known
+   MCPSimDevice chip2;
+   MCP mcp2;
+   bus.attach(0x21, &chip2);
+   mcp2.setBus(&bus);
+   mcp2.setup(0x21, 0xFF);
+   bus.reset();
+   CHECK(mcp2.readRegisters(REG_INTF, regs, 2) == 2);
+   CHECK(bus.reads == 2);                     // IOCON, then INTF and INTCAP
+   bus.reset();
+   CHECK(mcp2.readRegisters(REG_INTF, regs, 2) == 2);
+   CHECK(bus.reads == 1 && bus.writes == 0);  // IOCON known (SEQOP = 0)
+   mcp2.setRegister(REG_IOCON, IOCON_SEQOP);
+   bus.reset();
+   CHECK(mcp2.readRegisters(REG_INTF, regs, 2) == 2);
+   CHECK(bus.reads == 1 && bus.writes == 2);  // SEQOP off, read, SEQOP restored
+   CHECK(chip2.peek(REG_IOCON) == IOCON_SEQOP);
+
+   // loading the register cache (setRegisterCache, beginBatch) does not read INTCAP or GPIO: a pending interrupt is kept
+   MCPSimDevice chip3;
+   MCP mcp3;
+   bus.attach(0x22, &chip3);
+   mcp3.setBus(&bus);
+   mcp3.setup(0x22, GPIO_INPUT);
+   mcp3.setRegister(REG_GPINTEN, 0x01);
+   chip3.setInputs(0x01);
+   CHECK(chip3.isInterruptActive());
+   mcp3.setRegisterCache(true);
+   CHECK(chip3.isInterruptActive());
+   mcp3.setRegisterCache(false);
+   mcp3.beginBatch();
+   CHECK(chip3.isInterruptActive());
+   CHECK(mcp3.commit());
+   CHECK(chip3.isInterruptActive());
+   CHECK(mcp3.getRegister(REG_INTCAP) == 0x01);
+   CHECK(!chip3.isInterruptActive());
+
+   return TEST_RESULT();
+}
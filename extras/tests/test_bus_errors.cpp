@@ -0,0 +1,106 @@
+/**
+ * @file test_bus_errors.cpp
+ * @brief Bus status, opt-in retries (never for INTCAP / GPIO reads), verify-after-write and error counters
+ */
+
+#include "mcp_test.h"
+
+// a device that drops bit 0 of some IPOL writes
+class FlakyBus : public CountBus
+{
+public:
+   int corrupt = 0;
+
+   uint8_t writeRegisters(uint8_t address, uint8_t reg, const uint8_t *data, uint8_t n)
+   {
+      if (this->corrupt && reg == REG_IPOL && n == 1)
+      {
+         uint8_t value = data[0] ^ 1;
+         this->corrupt--;
+         return CountBus::writeRegisters(address, reg, &value, 1);
+      }
+      return CountBus::writeRegisters(address, reg, data, n);
+   }
+};
+
+int main()
+{
+   MCPSimDevice chip;
+   FlakyBus bus;
+   MCP mcp;
+   mcp23008_bus_errors e;
+   uint8_t value = 0x55;
+
+   bus.attach(0x20, &chip);
+   mcp.setBus(&bus);
+   mcp.setup(0x20, GPIO_OUTPUT);
+
+   // no retry by default: a missing device costs one transaction per access
+   MCP missing;
+   missing.setBus(&bus);
+   missing.setup(0x27, GPIO_OUTPUT);
+   bus.reset();
+   CHECK(missing.readRegister(REG_IODIR, &value) == MCP_BUS_NACK_ADDRESS);
+   CHECK(bus.transactions() == 1 && value == 0x55);
+   e = missing.getBusErrors();
+   CHECK(e.retries == 0 && e.failures >= 1);
+
+   // retries on request
+   mcp.setRetryPolicy(2, 10);
+   mcp.clearBusErrors();
+   bus.injectErrors(1);
+   CHECK(mcp.writeRegister(REG_OLAT, 0xA5) == MCP_BUS_OK);
+   CHECK(chip.peek(REG_OLAT) == 0xA5);
+   e = mcp.getBusErrors();
+   CHECK(e.writeErrors == 1 && e.retries == 1 && e.failures == 0 && e.lastError == MCP_BUS_NACK_DATA);
+
+   bus.injectErrors(3);
+   CHECK(mcp.readRegister(REG_OLAT, &value) == MCP_BUS_NACK_DATA && value == 0x55);
+   e = mcp.getBusErrors();
+   CHECK(e.readErrors == 3 && e.failures == 1 && e.retries == 3);
+
+   // INTCAP / GPIO reads are not repeated (the failed attempt may have cleared the interrupt)
+   mcp.clearBusErrors();
+   bus.injectErrors(1, MCP_BUS_TIMEOUT);
+   bus.reset();
+   CHECK(mcp.getRegister(REG_GPIO) == 0xFF && mcp.getLastError() == MCP_BUS_TIMEOUT);
+   CHECK(bus.transactions() == 1);
+   bus.injectErrors(1, MCP_BUS_TIMEOUT);
+   uint8_t intf, intcap;
+   CHECK(!mcp.getInterruptCapture(&intf, &intcap));
+   e = mcp.getBusErrors();
+   CHECK(e.retries == 0 && e.failures == 2);
+   CHECK(mcp.readRegister(REG_GPIO, &value) == MCP_BUS_OK && value == 0xA5);
+
+   // verify-after-write
+   mcp.setVerifyWrites(true);
+   bus.corrupt = 1;
+   bus.reset();
+   CHECK(mcp.writeRegister(REG_IPOL, 0x0F) == MCP_BUS_OK);
+   CHECK(chip.peek(REG_IPOL) == 0x0F);
+   e = mcp.getBusErrors();
+   CHECK(e.verifyErrors == 1);
+   CHECK(bus.writes == 2 && bus.reads == 2);
+
+   mcp.setRetryPolicy(0);
+   bus.corrupt = 1;
+   CHECK(mcp.writeRegister(REG_IPOL, 0x0F, true) == MCP_BUS_VERIFY_ERROR);
+   CHECK(mcp.getDirtyRegisters() & (1 << REG_IPOL));
+
+   // OLAT writes are not verified
+   bus.reset();
+   mcp.writeRegister(REG_OLAT, 1);
+   CHECK(bus.reads == 0);
+
+   // a verified burst that reaches INTF ~ GPIO reads back GPPU only: the pending interrupt is not cleared
+   uint8_t burst[] = {0x0F, 0, 0, 0x0F};
+   mcp.setRegister(REG_IODIR, 0x0F);
+   mcp.setRegister(REG_GPINTEN, 0x01);
+   chip.setInputs(0x01);
+   CHECK(chip.isInterruptActive());
+   CHECK(mcp.writeRegisters(REG_GPPU, burst, sizeof(burst)) == sizeof(burst));
+   CHECK(chip.peek(REG_GPPU) == 0x0F && chip.peek(REG_OLAT) == 0x0F);
+   CHECK(chip.isInterruptActive());
+
+   return TEST_RESULT();
+}
@@ -0,0 +1,88 @@
+/**
+ * @file test_config.cpp
+ * @brief Configuration snapshots: capture, diff, minimal-write apply, OLAT before IODIR and apply inside a caller batch
+ */
+
+#include "mcp_test.h"
+#include "pu2clr_mcp23008_config.h"
+
+// records the first register of each write
+class OrderBus : public CountBus
+{
+public:
+   uint8_t order[16];
+
+   uint8_t writeRegisters(uint8_t address, uint8_t reg, const uint8_t *data, uint8_t n)
+   {
+      if (this->writes < 16)
+         this->order[this->writes] = reg;
+      return CountBus::writeRegisters(address, reg, data, n);
+   }
+   int position(uint8_t reg)
+   {
+      for (int i = 0; i < this->writes && i < 16; i++)
+         if (this->order[i] == reg)
+            return i;
+      return -1;
+   }
+};
+
+int main()
+{
+   MCPSimDevice chip;
+   OrderBus bus;
+   MCP mcp;
+   MCPConfig inputCapture(0xFF, 0, 0xFF, 0, 0, 0, 0xFF, 0);
+   MCPConfig outputDrive(0x00, 0, 0, 0, 0, 0, 0, 0xA5);
+   MCPConfig saved, device;
+
+   bus.attach(0x20, &chip);
+   mcp.setBus(&bus);
+   mcp.setup(0x20, GPIO_INPUT);
+   mcp.setRegister(REG_IPOL, 0x0F);
+
+   // capture without the register cache: IODIR ~ GPPU and OLAT only (a pending interrupt is kept)
+   mcp.setRegister(REG_GPINTEN, 0x01);
+   chip.setInputs(0x01);
+   CHECK(chip.isInterruptActive());
+   CHECK(saved.capture(&mcp));
+   CHECK(chip.isInterruptActive());
+   CHECK(saved.getRegister(REG_IPOL) == 0x0F && saved.getRegister(REG_GPINTEN) == 0x01 && saved.getRegister(REG_IODIR) == 0xFF);
+
+   // diff
+   CHECK(inputCapture.diff(outputDrive) == ((1 << REG_IODIR) | (1 << REG_GPINTEN) | (1 << REG_GPPU) | (1 << REG_OLAT)));
+   CHECK(inputCapture == MCPConfig(0xFF, 0, 0xFF, 0, 0, 0, 0xFF, 0) && inputCapture != outputDrive);
+
+   // apply: only the changed registers; nothing when the device already has the configuration
+   // the caller's cache mode is kept and the pending interrupt is not cleared
+   CHECK(inputCapture.apply(&mcp));
+   CHECK(!mcp.isRegisterCacheEnabled() && !mcp.isBatching());
+   CHECK(chip.isInterruptActive());
+   mcp.setRegisterCache(true);
+   CHECK(device.capture(&mcp) && device == inputCapture);
+   CHECK(chip.peek(REG_IPOL) == 0 && chip.peek(REG_GPINTEN) == 0xFF && chip.peek(REG_GPPU) == 0xFF);
+   bus.reset();
+   CHECK(inputCapture.apply(&mcp));
+   CHECK(bus.transactions() == 0);
+
+   // pins become outputs: OLAT is written before IODIR; GPINTEN ~ GPPU in one burst
+   bus.reset();
+   CHECK(outputDrive.apply(&mcp));
+   CHECK(chip.peek(REG_IODIR) == 0 && chip.peek(REG_OLAT) == 0xA5 && chip.peek(REG_GPPU) == 0);
+   CHECK(bus.position(REG_OLAT) >= 0 && bus.position(REG_OLAT) < bus.position(REG_IODIR));
+   CHECK(bus.writes == 3 && bus.reads == 0);
+
+   // inside a caller batch: staged only; the caller commits
+   bus.reset();
+   mcp.beginBatch();
+   mcp.setRegister(REG_DEFVAL, 0x0F);   // overridden by the profile
+   CHECK(inputCapture.apply(&mcp));
+   CHECK(mcp.isBatching() && bus.transactions() == 0);
+   CHECK(chip.peek(REG_IODIR) == 0 && chip.peek(REG_GPINTEN) == 0);
+   CHECK(mcp.getRegister(REG_DEFVAL) == 0 && mcp.getRegister(REG_GPINTEN) == 0xFF);
+   CHECK(mcp.commit());
+   CHECK(device.capture(&mcp) && device == inputCapture);
+   CHECK(chip.peek(REG_IODIR) == 0xFF && chip.peek(REG_GPINTEN) == 0xFF && chip.peek(REG_OLAT) == 0);
+
+   return TEST_RESULT();
+}
@@ -0,0 +1,84 @@
+/**
+ * @file test_debounce.cpp
+ * @brief Debounced inputs: a bounce shorter than the debounce window gives no event; a stable change gives exactly one
+ */
+
+#include "mcp_test.h"
+#include "pu2clr_mcp23008_debounce.h"
+
+static MCPSimDevice chip;
+static CountBus bus;
+static MCP mcp;
+static MCPDebouncer buttons(&mcp);
+
+// one loop iteration: the INT pin is sampled as the ISR would do
+static bool step()
+{
+   if (chip.isInterruptActive())
+      buttons.onInterrupt();
+   return buttons.update();
+}
+
+// runs n iterations and returns the number of iterations with events
+static int run(int n, uint8_t *pressed, uint8_t *released)
+{
+   int events = 0;
+   *pressed = *released = 0;
+   for (int i = 0; i < n; i++)
+      if (step())
+      {
+         events++;
+         *pressed |= buttons.getPressed();
+         *released |= buttons.getReleased();
+      }
+   return events;
+}
+
+int main()
+{
+   uint8_t pressed, released;
+
+   bus.attach(0x20, &chip);
+   mcp.setBus(&bus);
+   chip.setInputs(0xFF);            // buttons released (pull up)
+   mcp.setup(0x20, GPIO_INPUT);
+   buttons.setup(0x03);             // GPIO 0 and 1; active low
+   buttons.setTiming(0, 3, 0);      // a sample per update; 3 equal samples; no long-press
+   CHECK(chip.peek(REG_GPINTEN) == 0x03 && chip.peek(REG_GPPU) == 0x03 && chip.peek(REG_INTCON) == 0);
+
+   // quiet inputs: no I2C traffic
+   bus.reset();
+   CHECK(run(10, &pressed, &released) == 0);
+   CHECK(bus.transactions() == 0);
+
+   // bounce: pressed for one sample only
+   chip.setInputs(0xFE);
+   CHECK(step() == false);          // INTCAP: pressed
+   chip.setInputs(0xFF);
+   CHECK(run(10, &pressed, &released) == 0);
+   CHECK(buttons.getState() == 0 && !buttons.isSettling());
+
+   // stable press: one event
+   chip.setInputs(0xFE);
+   CHECK(run(10, &pressed, &released) == 1);
+   CHECK(pressed == 0x01 && released == 0);
+   CHECK(buttons.getState() == 0x01);
+
+   // bounce on release, then a stable release: one event
+   chip.setInputs(0xFF);
+   step();
+   chip.setInputs(0xFE);
+   step();
+   chip.setInputs(0xFF);
+   CHECK(run(10, &pressed, &released) == 1);
+   CHECK(pressed == 0 && released == 0x01 && buttons.getState() == 0);
+
+   // two buttons change together: one event with both pins
+   chip.setInputs(0xFC);
+   CHECK(run(10, &pressed, &released) == 1);
+   CHECK(pressed == 0x03);
+   bus.reset();
+   CHECK(run(10, &pressed, &released) == 0 && bus.transactions() == 0);
+
+   return TEST_RESULT();
+}
@@ -0,0 +1,60 @@
+/**
+ * @file test_elision.cpp
+ * @brief Write elision: redundant writes are dropped, forced writes are sent, failed and marked registers are written by flush
+ */
+
+#include "mcp_test.h"
+
+int main()
+{
+   MCPSimDevice chip;
+   CountBus bus;
+   MCP mcp;
+
+   bus.attach(0x20, &chip);
+   mcp.setBus(&bus);
+   mcp.setup(0x20, GPIO_OUTPUT);
+   mcp.setWriteElision(true);
+   CHECK(mcp.isRegisterCacheEnabled());
+
+   // a write that does not change the register is not sent
+   mcp.setRegister(REG_GPPU, 0x0F);
+   mcp.turnGpioOn(MCP_GPIO1);
+   bus.reset();
+   mcp.setRegister(REG_GPPU, 0x0F);
+   mcp.turnGpioOn(MCP_GPIO1);
+   CHECK(bus.transactions() == 0);
+
+   // force = true sends it anyway
+   chip.writeRegister(REG_GPPU, 0);           // changed by other means: the shadow copy still has 0x0F
+   mcp.setRegister(REG_GPPU, 0x0F, true);
+   CHECK(bus.writes == 1 && chip.peek(REG_GPPU) == 0x0F);
+
+   // a failed write leaves the register dirty: the same value is not elided and flush writes it again
+   bus.injectErrors(1);
+   mcp.setRegister(REG_IPOL, 0x01);
+   CHECK(chip.peek(REG_IPOL) == 0 && mcp.getRegister(REG_IPOL) == 0x01);
+   bus.reset();
+   CHECK(mcp.flush());
+   CHECK(bus.writes == 1 && chip.peek(REG_IPOL) == 0x01);
+   bus.reset();
+   CHECK(mcp.flush());
+   CHECK(bus.transactions() == 0);            // nothing dirty any more
+
+   bus.injectErrors(1);
+   mcp.setRegister(REG_DEFVAL, 0x02);
+   bus.reset();
+   mcp.setRegister(REG_DEFVAL, 0x02);         // same value as the shadow copy, but dirty
+   CHECK(bus.writes == 1 && chip.peek(REG_DEFVAL) == 0x02);
+
+   // markDirty: registers changed by other means are written by the next flush
+   chip.writeRegister(REG_IODIR, 0xFF);
+   chip.writeRegister(REG_OLAT, 0);
+   mcp.markDirty((1 << REG_IODIR) | (1 << REG_OLAT));
+   bus.reset();
+   CHECK(mcp.flush());
+   CHECK(chip.peek(REG_IODIR) == GPIO_OUTPUT && chip.peek(REG_OLAT) == 0x02);
+   CHECK(bus.reads == 0 && bus.writes == 2);  // IODIR and OLAT are too far apart for one burst
+
+   return TEST_RESULT();
+}
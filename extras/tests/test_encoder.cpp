@@ -0,0 +1,64 @@
+/**
+ * @file test_encoder.cpp
+ * @brief Quadrature encoders: decoding, overruns, missed steps and one transaction per service call
+ */
+
+#include "mcp_test.h"
+#include "pu2clr_mcp23008_encoder.h"
+
+static const uint8_t forward[4] = {0, 1, 3, 2}; // A/B states of a forward quadrature cycle
+
+static MCPSimDevice chip;
+
+// encoder 0 on GPIO 0 (A) and GPIO 1 (B); encoder 1 on GPIO 2 (A) and GPIO 3 (B)
+static void setStates(uint8_t s0, uint8_t s1)
+{
+   chip.setInputs(((s0 >> 1) & 1) | ((s0 & 1) << 1) | (((s1 >> 1) & 1) << 2) | ((s1 & 1) << 3));
+}
+
+int main()
+{
+   CountBus bus;
+   MCP mcp;
+   MCPEncoder encoders(&mcp);
+
+   bus.attach(0x20, &chip);
+   mcp.setBus(&bus);
+   mcp.setup(0x20, GPIO_INPUT);   // register cache disabled
+
+   CHECK(encoders.add(MCP_GPIO0, MCP_GPIO1) == 0);
+   CHECK(encoders.add(MCP_GPIO2, MCP_GPIO3) == 1);
+   CHECK(encoders.add(MCP_GPIO4, MCP_GPIO4) == -1);
+   CHECK(mcp.isRegisterCacheEnabled());
+   CHECK(chip.peek(REG_GPINTEN) == 0x0F && chip.peek(REG_GPPU) == 0x0F);
+
+   // encoder 0 forward, encoder 1 backward; each service is one read
+   setStates(0, 0);
+   encoders.service();
+   bus.reset();
+   for (int i = 1; i <= 8; i++)
+   {
+      setStates(forward[i % 4], forward[(8 - i) % 4]);
+      if (chip.isInterruptActive())
+         encoders.onInterrupt();
+      CHECK(encoders.poll());
+   }
+   CHECK(encoders.getPosition(0) == 8 && encoders.getPosition(1) == -8);
+   CHECK(bus.transactions() == 8);
+
+   // two changes before the read: INTCAP has the first one, GPIO the second one (overrun)
+   setStates(forward[1], forward[0]);
+   setStates(forward[2], forward[0]);
+   encoders.onInterrupt();
+   encoders.poll();
+   CHECK(encoders.getPosition(0) == 10 && encoders.getOverruns() == 1 && encoders.getMissedSteps(0) == 0);
+
+   // both pins changed between INTCAP and GPIO: a step was lost
+   setStates(forward[3], forward[0]);
+   setStates(forward[1], forward[0]);
+   encoders.onInterrupt();
+   encoders.poll();
+   CHECK(encoders.getMissedSteps(0) == 1);
+
+   return TEST_RESULT();
+}
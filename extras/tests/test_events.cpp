@@ -0,0 +1,82 @@
+/**
+ * @file test_events.cpp
+ * @brief INTF + INTCAP capture in one transaction and the interrupt event queue
+ */
+
+#include "mcp_test.h"
+#include "pu2clr_mcp23008_events.h"
+
+static uint8_t changes = 0;
+static uint32_t lastTimestamp = 0;
+
+static void onChange(uint8_t gpio, bool level, const mcp23008_event *event)
+{
+   (void)gpio;
+   (void)level;
+   changes++;
+   lastTimestamp = event->timestamp;
+}
+
+int main()
+{
+   MCPSimDevice chip;
+   CountBus bus;
+   MCP mcp;
+   MCPEventQueue events(&mcp);
+   uint8_t intf, intcap;
+
+   bus.attach(0x20, &chip);
+   mcp.setBus(&bus);
+   mcp.setup(0x20, GPIO_INPUT);
+   chip.setInputs(0x0F);
+   mcp.setRegister(REG_GPINTEN, 0x0F);
+   chip.setInputs(0x0E);
+
+   // cache disabled and IOCON never read: still one transaction (the read starts at IOCON)
+   bus.reset();
+   CHECK(mcp.getInterruptCapture(&intf, &intcap));
+   CHECK(bus.transactions() == 1);
+   CHECK(intf == 0x01 && intcap == 0x0E && !chip.isInterruptActive());
+
+   // IOCON known: INTF and INTCAP only
+   chip.setInputs(0x0C);
+   bus.reset();
+   CHECK(mcp.getInterruptCapture(&intf, &intcap));
+   CHECK(bus.transactions() == 1);
+   CHECK(intf == 0x02 && intcap == 0x0C);
+
+   // SEQOP = 1: two reads, IOCON not changed
+   mcp.setRegister(REG_IOCON, IOCON_SEQOP);
+   chip.setInputs(0x08);
+   bus.reset();
+   CHECK(mcp.getInterruptCapture(&intf, &intcap));
+   CHECK(bus.reads == 2 && bus.writes == 0);
+   CHECK(intf == 0x04 && intcap == 0x08);
+
+   // SEQOP = 1 on a device whose IOCON is not known
+   MCP other;
+   other.setBus(&bus);
+   other.setup(0x20, GPIO_INPUT);
+   chip.setInputs(0x00);
+   bus.reset();
+   CHECK(other.getInterruptCapture(&intf, &intcap));
+   CHECK(bus.reads == 3 && bus.writes == 0);
+   CHECK(intf == 0x08 && intcap == 0x00);
+   mcp.setRegister(REG_IOCON, 0);
+
+   // event queue: the timestamp is the time of the first signal
+   events.attach(0, onChange);
+   events.attach(1, onChange);
+   chip.setInputs(0x0F);
+   mcp.getINTCAP();
+   chip.setInputs(0x0E);
+   events.onInterrupt();
+   uint32_t first = micros();
+   delayMicroseconds(200);
+   events.onInterrupt();
+   CHECK(events.pollEvents() == 1);
+   CHECK(changes == 1 && lastTimestamp <= first);
+   CHECK(events.pollEvents() == 0);
+
+   return TEST_RESULT();
+}
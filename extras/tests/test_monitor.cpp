@@ -0,0 +1,61 @@
+/**
+ * @file test_monitor.cpp
+ * @brief Bus monitor: transaction counters and per register accesses (bursts, repeated transfers and current address reads)
+ */
+
+#include "mcp_test.h"
+#include "pu2clr_mcp23008_monitor.h"
+
+int main()
+{
+   MCPSimDevice chip;
+   MCPSimulatedBus sim;
+   MCPBusMonitor monitor(&sim);
+   MCP mcp;
+   uint8_t regs[MCP_REG_COUNT];
+   uint8_t wave[] = {0x01, 0x00, 0x01};
+   uint8_t samples[5];
+   const mcp23008_bus_stats *stats = monitor.getStats();
+
+   sim.attach(0x20, &chip);
+   mcp.setBus(&monitor);
+   mcp.setRegisterCache(true);
+   mcp.setup(0x20, GPIO_OUTPUT);
+
+   // burst (SEQOP = 0): each register once
+   monitor.resetStats();
+   CHECK(mcp.readRegisters(REG_IODIR, regs, MCP_REG_COUNT) == MCP_REG_COUNT);
+   CHECK(stats->transactions == 1 && stats->frames == 2 && stats->bytesWritten == 1 && stats->bytesRead == MCP_REG_COUNT);
+   for (uint8_t reg = REG_IODIR; reg <= REG_OLAT; reg++)
+      CHECK(stats->registerAccess[reg] == 1);
+
+   // repeated transfer (SEQOP = 1): all bytes on the same register
+   monitor.resetStats();
+   CHECK(mcp.writeRepeated(REG_GPIO, wave, sizeof(wave)) == sizeof(wave));
+   CHECK(stats->transactions == 3);                        // IOCON, GPIO x 3, IOCON
+   CHECK(stats->registerAccess[REG_GPIO] == 3);
+   CHECK(stats->registerAccess[REG_OLAT] == 0);
+   CHECK(stats->registerAccess[REG_IOCON] == 2);
+
+   // current address reads (GPIO stream)
+   CHECK(mcp.beginGpioStream());
+   monitor.resetStats();
+   CHECK(mcp.readGpioSamples(samples, sizeof(samples)) == sizeof(samples));
+   CHECK(stats->transactions == 2);                        // parks the pointer, then reads
+   CHECK(stats->registerAccess[REG_GPIO] == sizeof(samples));
+   mcp.endGpioStream();
+
+   // current address read with SEQOP = 0 follows the pointer (rolls over after OLAT)
+   CHECK(monitor.writeRegisters(0x20, REG_GPIO, 0, 0) == MCP_BUS_OK);
+   monitor.resetStats();
+   CHECK(monitor.readCurrent(0x20, samples, 3) == MCP_BUS_OK);
+   CHECK(stats->registerAccess[REG_GPIO] == 1 && stats->registerAccess[REG_OLAT] == 1 && stats->registerAccess[REG_IODIR] == 1);
+
+   // failed transfers are counted as errors, not as register accesses
+   monitor.resetStats();
+   sim.injectErrors(1, MCP_BUS_NACK_DATA);
+   CHECK(monitor.readRegisters(0x20, REG_GPPU, regs, 1) == MCP_BUS_NACK_DATA);
+   CHECK(stats->nacks == 1 && stats->registerAccess[REG_GPPU] == 0);
+
+   return TEST_RESULT();
+}
@@ -0,0 +1,144 @@
+/**
+ * @file test_pingroup.cpp
+ * @brief Pin groups: gpioWrite, group writes, strobed writes (one transaction in stream mode), keypad scan and its limits
+ */
+
+#include "mcp_test.h"
+#include "pu2clr_mcp23008_pingroup.h"
+
+// records the last write and models a 4 x 4 keypad (rows on GPIO 0 ~ 3; columns on GPIO 4 ~ 7 with pull up)
+class KeypadBus : public CountBus
+{
+public:
+   MCPSimDevice *keypad = 0;
+   uint16_t keys = 0;           //!< pressed keys (bit row * 4 + column)
+   uint8_t last[8];
+   uint8_t lastCount = 0;
+
+   void update()
+   {
+      uint8_t olat, columns = 0xF0;
+      if (!this->keypad)
+         return;
+      olat = this->keypad->peek(REG_OLAT);
+      for (uint8_t row = 0; row < 4; row++)
+         for (uint8_t col = 0; col < 4; col++)
+            if (!(olat & (1 << row)) && (this->keys & (1 << (row * 4 + col))))
+               columns &= ~(1 << (4 + col));
+      this->keypad->setInputs(columns);
+   }
+   uint8_t writeRegisters(uint8_t address, uint8_t reg, const uint8_t *data, uint8_t n)
+   {
+      this->lastCount = (n < 8) ? n : 8;
+      memcpy(this->last, data, this->lastCount);
+      return CountBus::writeRegisters(address, reg, data, n);
+   }
+   uint8_t readRegisters(uint8_t address, uint8_t reg, uint8_t *data, uint8_t n)
+   {
+      this->update();
+      return CountBus::readRegisters(address, reg, data, n);
+   }
+   uint8_t readCurrent(uint8_t address, uint8_t *data, uint8_t n)
+   {
+      this->update();
+      return CountBus::readCurrent(address, data, n);
+   }
+};
+
+int main()
+{
+   MCPSimDevice chip, keypad, wide;
+   KeypadBus bus;
+   MCP mcp, kp, other;
+   MCPPinGroup lcd(&mcp), rows(&kp), columns(&kp), many(&other), few(&kp);
+
+   bus.attach(0x20, &chip);
+   bus.attach(0x21, &keypad);
+   bus.attach(0x22, &wide);
+   bus.keypad = &keypad;
+
+   // gpioWrite changes its own pin only (it used to clear GPIO 2)
+   mcp.setBus(&bus);
+   mcp.setRegisterCache(true);
+   mcp.setup(0x20, GPIO_OUTPUT);
+   bus.reset();
+   mcp.gpioWrite(MCP_GPIO5, HIGH);
+   mcp.gpioWrite(MCP_GPIO2, 5);
+   CHECK(chip.peek(REG_OLAT) == 0x24);
+   mcp.gpioWrite(MCP_GPIO5, LOW);
+   CHECK(chip.peek(REG_OLAT) == 0x04);
+   CHECK(bus.writes == 3 && bus.reads == 0);
+   mcp.setRegister(REG_IODIR, GPIO_INPUT);
+   mcp.setGPIOS(0x81);
+
+   // LCD group: D4 ~ D7 on GPIO 3 ~ 6, RS (logical bit 4) on GPIO 1, E on GPIO 2
+   const uint8_t lcdPins[] = {MCP_GPIO3, MCP_GPIO4, MCP_GPIO5, MCP_GPIO6, MCP_GPIO1};
+   CHECK(lcd.setup(lcdPins, 5, true, MCP_GPIO2));
+   CHECK(chip.peek(REG_IODIR) == 0x81 && lcd.getPinMask() == 0x7A);
+   CHECK(lcd.toPhysical(0x1F) == 0x7A && lcd.toLogical(0x7A) == 0x1F);
+   bus.reset();
+   lcd.write(0x11);
+   CHECK(chip.peek(REG_OLAT) == 0x8B && bus.transactions() == 1);  // GPIO 0 and 7 kept
+
+   // strobed write: data, data + E, data (IOCON SEQOP set and restored out of the stream mode)
+   bus.reset();
+   CHECK(lcd.writeStrobed(0x05));
+   CHECK(bus.writes == 3 && bus.reads == 0);
+   CHECK(chip.peek(REG_OLAT) == 0xA9 && chip.peek(REG_IOCON) == 0);
+   CHECK(mcp.beginGpioStream());
+   bus.reset();
+   CHECK(lcd.writeStrobed(0x05));
+   CHECK(bus.writes == 1 && bus.lastCount == 3);
+   CHECK(bus.last[0] == 0xA9 && bus.last[1] == 0xAD && bus.last[2] == 0xA9);
+
+   // both nibbles of 'A' (0x41) with RS = 1 in one transaction
+   bus.reset();
+   CHECK(lcd.writeNibbles('A', 0x10));
+   CHECK(bus.writes == 1 && bus.reads == 0 && bus.lastCount == 6);
+   CHECK(bus.last[0] == 0xA3 && bus.last[1] == 0xA7 && bus.last[2] == 0xA3);
+   CHECK(bus.last[3] == 0x8B && bus.last[4] == 0x8F && bus.last[5] == 0x8B);
+   CHECK(chip.peek(REG_OLAT) == 0x8B);
+   mcp.endGpioStream();
+
+   // strobed writes are refused during a batch (the pulse cannot be staged)
+   mcp.beginBatch();
+   bus.reset();
+   CHECK(!lcd.writeStrobed(0x0F));
+   CHECK(!lcd.writeNibbles(0x55));
+   CHECK(mcp.commit());
+   CHECK(bus.transactions() == 0 && chip.peek(REG_OLAT) == 0x8B);
+
+   // keypad: one write and one read per row
+   const uint8_t rowPins[] = {MCP_GPIO0, MCP_GPIO1, MCP_GPIO2, MCP_GPIO3};
+   const uint8_t colPins[] = {MCP_GPIO4, MCP_GPIO5, MCP_GPIO6, MCP_GPIO7};
+   kp.setBus(&bus);
+   kp.setRegisterCache(true);
+   kp.setup(0x21, GPIO_INPUT);
+   CHECK(rows.setup(rowPins, 4, true));
+   CHECK(columns.setup(colPins, 4, false));
+   CHECK(keypad.peek(REG_IODIR) == 0xF0 && keypad.peek(REG_GPPU) == 0xF0);
+   CHECK(rows.scanKeypad() == 0);       // not set up
+   CHECK(!rows.setupKeypad(&rows));      // same pins
+   CHECK(rows.setupKeypad(&columns));
+   bus.keys = (1 << 5) | (1 << 15);     // row 1 column 1; row 3 column 3
+   CHECK(kp.beginGpioStream());
+   bus.reset();
+   CHECK(rows.scanKeypad() == bus.keys);
+   CHECK(bus.writes == 5 && bus.reads == 4);
+   CHECK((keypad.peek(REG_OLAT) & 0x0F) == 0);
+   bus.keys = 0;
+   CHECK(rows.scanKeypad() == 0);
+
+   // more than 16 keys are rejected at setup (8 rows on another device x 3 columns)
+   const uint8_t allPins[] = {0, 1, 2, 3, 4, 5, 6, 7};
+   const uint8_t threePins[] = {MCP_GPIO4, MCP_GPIO5, MCP_GPIO6};
+   other.setBus(&bus);
+   other.setup(0x22, GPIO_OUTPUT);
+   CHECK(many.setup(allPins, 8, true));
+   CHECK(few.setup(threePins, 3, false));
+   CHECK(!many.setupKeypad(&few));
+   bus.reset();
+   CHECK(many.scanKeypad() == 0 && bus.transactions() == 0);
+
+   return TEST_RESULT();
+}
@@ -0,0 +1,70 @@
+/**
+ * @file test_pwm.cpp
+ * @brief Software PWM: pins start low, one OLAT write per edge, duty changes at the next period and non-PWM pins changed while the PWM runs
+ */
+
+#include "mcp_test.h"
+#include "pu2clr_mcp23008_pwm.h"
+
+int main()
+{
+   MCPSimDevice chip;
+   CountBus bus;
+   MCP mcp;
+   MCPPwm pwm(&mcp);
+   int on[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+
+   bus.attach(0x20, &chip);
+   mcp.setBus(&bus);
+   mcp.setup(0x20, 0x0E);           // GPIO 0 and 4 ~ 7 are outputs
+   mcp.turnGpioOn(MCP_GPIO0);
+   mcp.setRegister(REG_OLAT, 0x61); // latched high on GPIO 5 and 6, which are still inputs
+
+   pwm.setup(0xF0, 100, 8);         // GPIO 4 ~ 7; 8 steps
+   CHECK(mcp.isRegisterCacheEnabled());
+   CHECK(chip.peek(REG_OLAT) == 0x01);   // the PWM pins start low
+   pwm.setDuty(MCP_GPIO4, 2);
+   pwm.setDuty(MCP_GPIO5, 4);
+   pwm.setDuty(MCP_GPIO6, 2);
+   pwm.setDuty(MCP_GPIO7, 8);
+   CHECK(chip.peek(REG_IODIR) == 0x0E);
+
+   // two periods: 3 edges each (on, GPIO 4 and 6 off, GPIO 5 off); GPIO 7 always on
+   bus.reset();
+   for (int t = 0; t < 16; t++)
+   {
+      pwm.tick();
+      uint8_t olat = chip.peek(REG_OLAT);
+      CHECK(olat & 0x01);
+      for (int gpio = 4; gpio < 8; gpio++)
+         if (olat & (1 << gpio))
+            on[gpio]++;
+   }
+   CHECK(on[4] == 4 && on[5] == 8 && on[6] == 4 && on[7] == 16);
+   CHECK(bus.writes == 6 && bus.reads == 0 && pwm.getEdgeCount() == 3);
+
+   // a non PWM pin changed while the PWM runs is not put back by the next edges
+   pwm.tick();                      // tick 0
+   mcp.turnGpioOff(MCP_GPIO0);
+   mcp.gpioWrite(MCP_GPIO1, HIGH);  // input pin: OLAT only
+   for (int t = 1; t < 8; t++)
+      pwm.tick();
+   CHECK(!(chip.peek(REG_OLAT) & 0x01) && (chip.peek(REG_OLAT) & 0x02));
+   CHECK((chip.peek(REG_OLAT) & 0xF0) == 0x80);
+
+   // duty change: used from the next period on
+   pwm.tick();                      // tick 0
+   pwm.setDuty(MCP_GPIO7, 0);
+   for (int t = 1; t < 8; t++)
+   {
+      pwm.tick();
+      CHECK(chip.peek(REG_OLAT) & 0x80);
+   }
+   pwm.tick();
+   CHECK(!(chip.peek(REG_OLAT) & 0x80));
+
+   CHECK(MCPPwm::getMaxFrequency(400000, 32) == 431);
+   CHECK(MCPPwm::getMaxFrequency(100000, 32) == 107);
+
+   return TEST_RESULT();
+}
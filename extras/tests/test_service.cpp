@@ -0,0 +1,184 @@
+/**
+ * @file test_service.cpp
+ * @brief Linux service mode: request queue, pin write coalescing, tick latency, interrupts on a shared line and an interrupt pending at start
+ */
+
+#include "mcp_test.h"
+#include "pu2clr_mcp23008_service.h"
+
+#if defined(__linux__)
+
+#include <chrono>
+
+#define WRITER_THREADS 8
+#define WRITES_PER_THREAD 50
+
+static MCPService *service;
+static uint8_t outputs;
+static MCPSimDevice chips[3];
+static std::atomic<int> hits(0);
+static std::atomic<int> statusErrors(0);
+static uint8_t intfSeen[3];
+static std::atomic<int> nested(0);
+static std::atomic<bool> blocked(false);
+static std::atomic<bool> release(false);
+
+static void writer(uint8_t pin)
+{
+   for (int k = 0; k < WRITES_PER_THREAD; k++)
+      if (service->writePins(outputs, 1 << pin, (k & 1) ? 0 : 1 << pin) != MCP_BUS_OK)
+         statusErrors++;
+   service->writePins(outputs, 1 << pin, 1 << pin);
+}
+
+static void onInput(uint8_t device, uint8_t intf, uint8_t intcap, void *context)
+{
+   (void)intcap;
+   (void)context;
+   intfSeen[device] |= intf;
+   if (service->writePins(outputs, 0x40, 0x40) == MCP_BUS_ERROR && service->postPins(outputs, 0x40, 0x40))
+      nested++;   // waiting here would block the service thread: only posting is allowed
+   if (device == 2)
+      chips[1].setInputs(0xFE);   // device 1 fires after its INTF was read in this scan
+   hits++;
+}
+
+static void onPending(uint8_t device, uint8_t intf, uint8_t intcap, void *context)
+{
+   (void)context;
+   if (device == 0 && intf == 0x01 && intcap == 0xFF)
+      hits++;
+}
+
+static void onBlock(uint8_t status, uint8_t value, void *context)
+{
+   (void)status;
+   (void)value;
+   (void)context;
+   blocked = true;
+   while (!release)
+      std::this_thread::yield();
+}
+
+static void onDone(uint8_t status, uint8_t value, void *context)
+{
+   (void)value;
+   if (status == MCP_BUS_OK)
+      (*(std::atomic<int> *)context)++;
+}
+
+int main()
+{
+   CountBus bus;
+   MCP mcp[3];
+   MCPService svc(&bus);
+   std::thread writers[WRITER_THREADS];
+   std::atomic<int> done(0);
+   uint8_t value = 0;
+
+   service = &svc;
+   for (uint8_t i = 0; i < 3; i++)
+   {
+      bus.attach(0x20 + i, &chips[i]);
+      chips[i].setInputs(0xFF);
+      mcp[i].setBus(&bus);
+   }
+   mcp[0].setup(0x20, GPIO_OUTPUT);
+   for (uint8_t i = 1; i < 3; i++)
+   {
+      mcp[i].setup(0x20 + i, GPIO_INPUT);
+      mcp[i].interruptGpioOn(MCP_GPIO0, 1);
+      mcp[i].setRegister(REG_INTCON, 0);
+   }
+   outputs = svc.addDevice(&mcp[0]);
+   CHECK(svc.addDevice(&mcp[1]) == 1 && svc.addDevice(&mcp[2]) == 2);
+   CHECK(svc.subscribe(0xFF, onInput));
+   CHECK(svc.writePins(outputs, 1, 1) == MCP_BUS_ERROR);   // not running
+
+   // pin writes from many threads: fewer OLAT writes than pin write requests
+   svc.setTick(2000);
+   CHECK(svc.start());
+   for (uint8_t t = 0; t < WRITER_THREADS; t++)
+      writers[t] = std::thread(writer, t);
+   for (uint8_t t = 0; t < WRITER_THREADS; t++)
+      writers[t].join();
+   CHECK(statusErrors == 0);
+   CHECK(svc.getPinWrites() == WRITER_THREADS * (WRITES_PER_THREAD + 1));
+   CHECK(svc.getOlatWrites() < svc.getPinWrites());
+   CHECK(svc.getRegister(outputs, REG_OLAT, &value) == MCP_BUS_OK && value == 0xFF);
+
+   // the requests of a device are executed in order
+   CHECK(svc.postPins(outputs, 0x0F, 0x00));
+   CHECK(svc.getRegister(outputs, REG_GPIO, &value) == MCP_BUS_OK && value == 0xF0);
+
+   // no tick wait when there are no pin writes to coalesce
+   svc.setTick(500000);
+   std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+   for (int i = 0; i < 3; i++)
+      CHECK(svc.getRegister(outputs, REG_OLAT, &value) == MCP_BUS_OK);
+   CHECK(std::chrono::steady_clock::now() - start < std::chrono::milliseconds(250));
+   svc.setTick(1000);
+
+   // shared line: device 1 fires while device 2 is serviced, so the devices are scanned again
+   chips[2].setInputs(0xFE);
+   svc.notifyInterrupt();
+   for (int i = 0; i < 1000 && hits < 2; i++)
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+   CHECK(hits == 2);
+   CHECK(intfSeen[1] == 0x01 && intfSeen[2] == 0x01);
+   CHECK(svc.getInterrupts() == 1);
+   CHECK(nested == 2);
+   CHECK(svc.getRegister(outputs, REG_OLAT, &value) == MCP_BUS_OK && (value & 0x40));
+
+   // fixed request pool: with the service thread busy, the request MCP_SERVICE_POOL_SIZE + 1 is refused
+   svc.setTick(0);
+   CHECK(svc.postPins(outputs, 0x20, 0x20, onBlock));
+   while (!blocked)
+      std::this_thread::yield();
+   for (int i = 0; i < MCP_SERVICE_POOL_SIZE; i++)
+      CHECK(svc.postPins(outputs, 0x20, 0x00, onDone, &done));
+   CHECK(!svc.postPins(outputs, 0x20, 0x20));
+   release = true;
+   for (int i = 0; i < 1000 && done < MCP_SERVICE_POOL_SIZE; i++)
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+   CHECK(done == MCP_SERVICE_POOL_SIZE);   // the nodes are back in the pool
+   CHECK(svc.getRegister(outputs, REG_OLAT, &value) == MCP_BUS_OK && !(value & 0x20));
+   done = 0;
+   svc.setTick(1000);
+
+   // stop executes the requests already posted; new requests are refused
+   for (int i = 0; i < 10; i++)
+      svc.postPins(outputs, 0x80, (i & 1) ? 0x00 : 0x80, onDone, &done);
+   svc.stop();
+   CHECK(done == 10);
+   CHECK(!svc.postPins(outputs, 1, 1));
+   CHECK(chips[1].getIntPinLevel() && chips[2].getIntPinLevel());   // INT released on both devices
+
+   // an interrupt pending before start (no new edge will come) is serviced by the first scan
+   MCPService late(&bus);
+   hits = 0;
+   chips[1].setInputs(0xFF);
+   CHECK(!chips[1].getIntPinLevel());
+   CHECK(late.addDevice(&mcp[1]) == 0);
+   CHECK(late.subscribe(0, onPending));
+   CHECK(!chips[1].getIntPinLevel());   // adding the device does not clear it
+   CHECK(late.start());
+   for (int i = 0; i < 1000 && hits < 1; i++)
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+   CHECK(hits == 1);
+   CHECK(chips[1].getIntPinLevel());
+   CHECK(late.getInterrupts() == 0);
+   late.stop();
+
+   return TEST_RESULT();
+}
+
+#else
+
+int main()
+{
+   puts("ok");   // Linux only
+   return 0;
+}
+
+#endif
@@ -0,0 +1,104 @@
+/**
+ * @file test_shared_int.cpp
+ * @brief Shared open-drain interrupt line: early exit and devices that fire during the scan
+ */
+
+#include "mcp_test.h"
+#include "pu2clr_mcp23008_shared_int.h"
+
+static MCPSimDevice chips[6];
+static int hits = 0;
+static int lastDevice = -1;
+static bool fireLate = false;
+
+static bool lineAsserted()
+{
+   for (uint8_t i = 0; i < 6; i++)
+      if (!chips[i].getIntPinLevel())
+         return true;
+   return false;
+}
+
+static void onPin(uint8_t device, uint8_t gpio, bool level)
+{
+   (void)gpio;
+   (void)level;
+   hits++;
+   lastDevice = device;
+   if (fireLate && device == 3)
+   {   // device 4 fires after its INTF was checked in this scan
+      fireLate = false;
+      chips[4].setInputs(0xFE);
+   }
+}
+
+int main()
+{
+   CountBus bus;
+   MCP mcp[6];
+   MCPSharedInterrupt shared;
+
+   for (uint8_t i = 0; i < 6; i++)
+   {
+      bus.attach(0x20 + i, &chips[i]);
+      chips[i].setInputs(0xFF);
+      mcp[i].setBus(&bus);
+      mcp[i].setRegisterCache(true);
+      mcp[i].setup(0x20 + i, GPIO_INPUT);
+      uint8_t d = shared.add(&mcp[i]);
+      mcp[i].interruptGpioOn(MCP_GPIO0, 1);
+      mcp[i].setRegister(REG_INTCON, 0);
+      shared.attach(d, MCP_GPIO0, onPin);
+   }
+   shared.setLineReader(lineAsserted);
+   CHECK(!lineAsserted());
+
+   // one device fires: the scan stops when the line is released
+   chips[4].setInputs(0xFE);
+   CHECK(lineAsserted());
+   shared.onInterrupt();
+   CHECK(shared.poll() == 1);
+   CHECK(hits == 1 && lastDevice == 4);
+   CHECK(!lineAsserted());
+
+   // the most recently active device is checked first (INTF + INTCAP)
+   chips[4].setInputs(0xFF);
+   mcp[4].getINTCAP();
+   chips[4].setInputs(0xFE);
+   bus.reset();
+   CHECK(shared.service() == 1);
+   CHECK(bus.reads == 2);
+
+   // a device fires after its INTF was checked: the line stays low and no new edge arrives
+   chips[4].setInputs(0xFF);
+   mcp[4].getINTCAP();
+   fireLate = true;
+   chips[3].setInputs(0xFE);      // device 4 is checked first (most recently active)
+   hits = 0;
+   shared.onInterrupt();
+   CHECK(shared.poll() == 2);     // 3 and then 4 in a second scan
+   CHECK(hits == 2 && lastDevice == 4);
+   CHECK(!lineAsserted());
+   CHECK(shared.poll() == 0);     // nothing left signaled
+
+   // without a line reader, a scan that found a device is followed by a new scan
+   shared.setLineReader(0);
+   chips[2].setInputs(0xFE);
+   shared.onInterrupt();
+   CHECK(shared.poll() == 1);
+   CHECK(shared.poll() == 0);
+   CHECK(shared.poll() == 0);
+
+   // a device that does not answer is skipped: no fake events (a failed INTF read is not 0xFF = all pins fired)
+   bus.attach(0x25, 0);
+   hits = 0;
+   chips[1].setInputs(0xFE);
+   shared.onInterrupt();
+   CHECK(shared.poll() == 1);
+   CHECK(hits == 1 && lastDevice == 1);
+   bus.injectErrors(6);
+   shared.onInterrupt();
+   CHECK(shared.poll() == 0 && hits == 1);
+
+   return TEST_RESULT();
+}
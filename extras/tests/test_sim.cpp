@@ -0,0 +1,77 @@
+/**
+ * @file test_sim.cpp
+ * @brief Simulated transport and MCP23008 model: register access, sequential operation, GPIO stream and interrupts
+ */
+
+#include "mcp_test.h"
+
+int main()
+{
+   MCPSimDevice chip;
+   CountBus bus;
+   MCP mcp;
+   uint8_t regs[MCP_REG_COUNT];
+   uint8_t samples[40];
+
+   bus.attach(0x21, &chip);
+   mcp.setBus(&bus);
+
+   // discovery and setup
+   CHECK(bus.probe(0x21) == MCP_BUS_OK);
+   CHECK(bus.probe(0x22) == MCP_BUS_NACK_ADDRESS);
+   CHECK(mcp.lookForDevice() == 0x21);
+   mcp.setup(0x21, 0x0F);
+   CHECK(chip.peek(REG_IODIR) == 0x0F);
+
+   // outputs and inputs
+   mcp.setRegisterCache(true);
+   mcp.turnGpioOn(5);
+   mcp.turnGpioOn(7);
+   mcp.turnGpioOff(5);
+   CHECK(chip.peek(REG_OLAT) == 0x80);
+   chip.setInputs(0x05);
+   CHECK(mcp.gpioRead(2) && !mcp.gpioRead(1));
+
+   // sequential reads and writes (SEQOP = 0 and SEQOP = 1 on the device)
+   CHECK(mcp.readRegisters(REG_IODIR, regs, MCP_REG_COUNT) == MCP_REG_COUNT);
+   CHECK(regs[REG_IODIR] == 0x0F && regs[REG_OLAT] == 0x80);
+   mcp.setRegister(REG_IOCON, IOCON_SEQOP);
+   CHECK(mcp.readRegisters(REG_IODIR, regs, MCP_REG_COUNT) == MCP_REG_COUNT);
+   CHECK(regs[REG_IOCON] == IOCON_SEQOP && chip.peek(REG_IOCON) == IOCON_SEQOP);
+   uint8_t config[] = {0x0F, 0, 0x0F, 0x0F, 0, 0, 0x0F};
+   CHECK(mcp.writeRegisters(REG_IODIR, config, sizeof(config)) == sizeof(config));
+   CHECK(chip.peek(REG_GPPU) == 0x0F && chip.peek(REG_IOCON) == 0);
+
+   // GPIO stream: the address pointer is parked on GPIO once; then one read per burst of samples
+   mcp.beginGpioStream();
+   CHECK(chip.peek(REG_IOCON) & IOCON_SEQOP);
+   CHECK(mcp.readGpioSamples(samples, sizeof(samples)) == sizeof(samples));
+   CHECK(samples[39] == 0x85);
+   bus.reset();
+   CHECK(mcp.readGpioSamples(samples, 16) == 16);
+   CHECK(bus.writes == 0 && bus.reads == 1);
+   chip.setInputs(0x01);
+   CHECK(mcp.getGPIOS() == 0x81);
+   mcp.endGpioStream();
+   CHECK(chip.peek(REG_IOCON) == 0);
+
+   // interrupt on change: reading INTCAP clears the interrupt
+   chip.setInputs(0x0F);
+   mcp.setRegister(REG_INTCON, 0);
+   mcp.setRegister(REG_GPINTEN, 0x0F);
+   mcp.getINTCAP();
+   chip.setInputs(0x0B);
+   CHECK(chip.isInterruptActive() && !chip.getIntPinLevel());
+   CHECK(mcp.getINTF() == 0x04);
+   CHECK(mcp.getINTCAP() == 0x8B);
+   CHECK(!chip.isInterruptActive() && chip.getIntPinLevel());
+
+   // failed transfers do not reach the device
+   bus.injectErrors(1, MCP_BUS_NACK_DATA);
+   CHECK(bus.writeRegisters(0x21, REG_GPPU, config, 1) == MCP_BUS_NACK_DATA);
+   CHECK(chip.peek(REG_GPPU) == 0x0F);
+   CHECK(bus.writeRegisters(0x21, REG_GPPU, config, 1) == MCP_BUS_OK);
+   CHECK(chip.peek(REG_GPPU) == 0x0F);
+
+   return TEST_RESULT();
+}
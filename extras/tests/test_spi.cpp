@@ -0,0 +1,77 @@
+/**
+ * @file test_spi.cpp
+ * @brief MCP23S08 transport: two devices on one chip select (HAEN), sequential bursts, GPIO stream and probe of absent devices
+ */
+
+#include "mcp_test.h"
+
+int main()
+{
+   MCPSimDevice chip0, chip1;
+   MCPSimSpiPort port;
+   MCPSpiBus spiBus(&port);
+   MCP mcp0, mcp1;
+   uint8_t regs[MCP_REG_COUNT];
+   uint8_t samples[8];
+   uint8_t config[MCP_REG_COUNT] = {0x0F, 0x01, 0x0F, 0x0F, 0x0F, 0, 0x0F, 0, 0, 0, 0x50};
+
+   port.attach(0, &chip0);
+   port.attach(1, &chip1);
+
+   // HAEN = 0: both devices answer to A1 A0 = 00; a single IOCON write enables the address pins of both
+   CHECK(spiBus.probe(0x20) == MCP_BUS_OK);
+   CHECK(spiBus.probe(0x21) == MCP_BUS_NACK_ADDRESS);
+   spiBus.enableHardwareAddress();
+   CHECK((chip0.peek(REG_IOCON) & IOCON_HAEN) && (chip1.peek(REG_IOCON) & IOCON_HAEN));
+   CHECK(spiBus.probe(0x21) == MCP_BUS_OK);
+
+   mcp0.setBus(&spiBus);
+   mcp0.setup(0x20, GPIO_OUTPUT);
+   mcp1.setBus(&spiBus);
+   mcp1.setup(0x21, GPIO_INPUT);
+   mcp0.turnGpioOn(MCP_GPIO3);
+   CHECK(chip0.peek(REG_OLAT) == 0x08 && chip1.peek(REG_OLAT) == 0);
+   CHECK(chip0.peek(REG_IODIR) == 0x00 && chip1.peek(REG_IODIR) == 0xFF);
+   chip1.setInputs(0xA5);
+   CHECK(mcp1.getGPIOS() == 0xA5);
+
+   // 11 register burst write and read (one frame each); IOCON keeps HAEN
+   config[REG_IOCON] = IOCON_HAEN;
+   CHECK(mcp0.writeRegisters(REG_IODIR, config, MCP_REG_COUNT) == MCP_REG_COUNT);
+   CHECK(chip0.peek(REG_IPOL) == 0x01 && chip0.peek(REG_GPPU) == 0x0F && chip0.peek(REG_OLAT) == 0x50);
+   CHECK(chip1.peek(REG_GPPU) == 0);
+   chip0.setInputs(0x02);
+   CHECK(mcp0.readRegisters(REG_IODIR, regs, MCP_REG_COUNT) == MCP_REG_COUNT);
+   CHECK(regs[REG_IODIR] == 0x0F && regs[REG_INTCON] == 0x0F && regs[REG_IOCON] == IOCON_HAEN);
+   CHECK(regs[REG_GPIO] == 0x53 && regs[REG_OLAT] == 0x50);   // inputs 0x02 inverted by IPOL on GPIO 0; outputs from OLAT
+
+   // GPIO stream: readCurrent repeats the GPIO register of the last frame
+   CHECK(mcp1.beginGpioStream());
+   CHECK(chip1.peek(REG_IOCON) & IOCON_SEQOP);
+   CHECK(mcp1.readGpioSamples(samples, sizeof(samples)) == sizeof(samples));
+   CHECK(samples[0] == 0xA5 && samples[7] == 0xA5);
+   chip1.setInputs(0x3C);
+   CHECK(spiBus.readCurrent(0x21, samples, 2) == MCP_BUS_OK);
+   CHECK(samples[0] == 0x3C && samples[1] == 0x3C);
+   mcp1.endGpioStream();
+   CHECK(!(chip1.peek(REG_IOCON) & IOCON_SEQOP) && (chip1.peek(REG_IOCON) & IOCON_HAEN));
+
+   // absent devices: MISO floating high or low
+   CHECK(spiBus.probe(0x23) == MCP_BUS_NACK_ADDRESS);
+   port.setIdleLevel(0x00);
+   CHECK(spiBus.probe(0x23) == MCP_BUS_NACK_ADDRESS);
+   CHECK(spiBus.probe(0x24) == MCP_BUS_NACK_ADDRESS);
+   CHECK(spiBus.probe(0x21) == MCP_BUS_OK);
+
+   // a device at the IOCON reset value (0x00) is found and its IOCON is left unchanged
+   MCPSimDevice chip2;
+   MCPSimSpiPort port2;
+   MCPSpiBus spiBus2(&port2);
+   port2.attach(0, &chip2);
+   port2.setIdleLevel(0x00);
+   CHECK(spiBus2.probe(0x20) == MCP_BUS_OK);
+   CHECK(chip2.peek(REG_IOCON) == 0);
+   CHECK(spiBus2.probe(0x21) == MCP_BUS_NACK_ADDRESS);
+
+   return TEST_RESULT();
+}
@@ -0,0 +1,52 @@
+/**
+ * @file test_static.cpp
+ * @brief Compile-time specialized driver: MCPPins masks, folded multi-pin writes and the GPPU shadow after an MCU-only reset
+ */
+
+#include "mcp_test.h"
+#include "pu2clr_mcp23008_static.h"
+
+typedef MCPPins<MCP_GPIO0, MCP_GPIO2, MCP_GPIO6> Leds;
+typedef MCPPins<MCP_GPIO4, MCP_GPIO5> Buttons;
+
+static_assert(Leds::mask == 0x45, "MCPPins mask");
+static_assert(MCPPins<>::mask == 0, "empty MCPPins mask");
+
+int main()
+{
+   MCPSimDevice chip;
+   CountBus bus;
+   MCP23008<0x21, CountBus> mcp(bus);
+
+   bus.attach(0x21, &chip);
+
+   // the device kept its pull ups while the MCU was reset
+   chip.writeRegister(REG_GPPU, 0x0F);
+   mcp.setup(Buttons::mask);          // GPIO 4 and 5 are inputs
+   CHECK(chip.peek(REG_IODIR) == Buttons::mask && chip.peek(REG_OLAT) == 0);
+   mcp.pullUpOn<Buttons::mask>();
+   CHECK(chip.peek(REG_GPPU) == 0x3F);
+
+   // one write per multi-pin update; nothing when the value does not change
+   bus.reset();
+   mcp.turnOn<MCP_GPIO1>();
+   mcp.update<Leds::mask, MCPPins<MCP_GPIO1>::mask>();
+   CHECK(chip.peek(REG_OLAT) == Leds::mask && mcp.getOutputs() == Leds::mask);
+   CHECK(bus.writes == 2 && bus.reads == 0);
+   mcp.update<Leds::mask>();
+   mcp.turnOff<MCP_GPIO1>();
+   mcp.pinWrite<MCP_GPIO0>(HIGH);
+   CHECK(bus.writes == 2);
+   mcp.writePins<MCPPins<MCP_GPIO6, MCP_GPIO7>::mask>(0x80);
+   CHECK(chip.peek(REG_OLAT) == 0x85 && bus.writes == 3);
+
+   // reads
+   chip.setInputs(0x10);
+   CHECK(mcp.readPins<Buttons::mask>() == 0x10);
+   CHECK(mcp.pinRead<MCP_GPIO4>() && !mcp.pinRead<MCP_GPIO5>());
+   mcp.setRegister(REG_GPIO, 0x01);
+   CHECK(chip.peek(REG_OLAT) == 0x01 && mcp.getOutputs() == 0x01);
+   CHECK(mcp.getRegister(REG_GPPU) == 0x3F);
+
+   return TEST_RESULT();
+}
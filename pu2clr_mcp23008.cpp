@@ -20,10 +20,120 @@
 
 #include "pu2clr_mcp23008.h"
 
+#if defined(ARDUINO)
+
 #include <Wire.h>
 
+/** @defgroup group00 MCP23008 transport (bus) */
+
+/**
+ * @ingroup group00
+ * @brief Starts the Wire object (only once, even if it is shared by many MCP devices)
+ */
+void MCPWireBus::begin() {
+    if (this->started)
+        return;
+    this->wire->begin();
+    this->started = true;
+}
+
+/**
+ * @ingroup group00
+ * @brief Sets the I2C bus clock
+ * @param freq 100000 = 100KHz; 400000 = 400KHz etc 
+ */
+void MCPWireBus::setClock(long freq) {
+    this->wire->setClock(freq);
+}
+
+/**
+ * @ingroup group00
+ * @brief Checks if a device acknowledges a given address
+ * @param address device address
+ * @return uint8_t Wire.endTransmission status
+ */
+uint8_t MCPWireBus::probe(uint8_t address) {
+    this->wire->beginTransmission(address);
+    return this->wire->endTransmission();
+}
+
+/**
+ * @ingroup group00
+ * @brief Writes the register address followed by n bytes in a single I2C transmission
+ * @param address device address
+ * @param reg first register
+ * @param data values
+ * @param n number of bytes (n = 0 moves the device address pointer only)
+ * @return uint8_t Wire.endTransmission status 
+ */
+uint8_t MCPWireBus::writeRegisters(uint8_t address, uint8_t reg, const uint8_t *data, uint8_t n) {
+    if (n >= MCP_I2C_BUFFER_LENGTH)
+        return MCP_BUS_DATA_TOO_LONG;
+    this->wire->beginTransmission(address);
+    this->wire->write(reg);
+    for (uint8_t i = 0; i < n; i++)
+        this->wire->write(data[i]);
+    return this->wire->endTransmission();
+}
+
+/**
+ * @ingroup group00
+ * @brief Writes the register address and reads n bytes 
+ * @param address device address
+ * @param reg first register
+ * @param data buffer
+ * @param n number of bytes
+ * @return uint8_t bus status
+ */
+uint8_t MCPWireBus::readRegisters(uint8_t address, uint8_t reg, uint8_t *data, uint8_t n) {
+    uint8_t status = this->writeRegisters(address, reg, 0, 0);
+    if (status != MCP_BUS_OK)
+        return status;
+    return this->readCurrent(address, data, n);
+}
+
+/**
+ * @ingroup group00
+ * @brief Reads n bytes from the current device address pointer
+ * @details Transfers longer than MCP_I2C_BUFFER_LENGTH are split in more than one read. 
+ * @param address device address
+ * @param data buffer
+ * @param n number of bytes
+ * @return uint8_t bus status
+ */
+uint8_t MCPWireBus::readCurrent(uint8_t address, uint8_t *data, uint8_t n) {
+    uint8_t count = 0, chunk, received;
+    while (count < n)
+    {
+        chunk = (n - count > MCP_I2C_BUFFER_LENGTH) ? MCP_I2C_BUFFER_LENGTH : n - count;
+        received = this->wire->requestFrom((int)address, (int)chunk);
+        for (uint8_t i = 0; i < received; i++)
+            data[count++] = this->wire->read();
+        if (received < chunk)
+            return MCP_BUS_SHORT_READ;
+    }
+    return MCP_BUS_OK;
+}
+
+#endif
+
 /** @defgroup group01 MCP23008 basic functions */
 
+/**
+ * @ingroup group01
+ * @brief Returns the default transport 
+ * @details On Arduino boards, it is the MCPWireBus (Wire object). On other builds there is no default transport (see setBus).
+ * @return MCPBus* 
+ */
+MCPBus *MCP::defaultBus() {
+#if defined(ARDUINO)
+    static MCPWireBus wireBus;
+    return &wireBus;
+#else
+    return 0;
+#endif
+}
+
 /**
  * @ingroup group01
  * @brief Look for MCP23008 device I2C Address
@@ -31,13 +141,10 @@
  * @return uint8_t the I2C address of the first MCP23008 device connect in the I2C bus
  */
 uint8_t MCP::lookForDevice() {
-    int err = 0;
-    Wire.begin();
-    for (int addr = 0x20; addr <= 0x27; addr++)
+    this->bus->begin();
+    for (uint8_t addr = 0x20; addr <= 0x27; addr++)
     {
-        Wire.beginTransmission(addr);
-        err = Wire.endTransmission();
-        if (err == 0)
+        if (this->bus->probe(addr) == MCP_BUS_OK)
             return addr;
     }
     // Any MCP23008 device was found
@@ -59,6 +166,7 @@ void MCP::reset() {
         delay(5);
         digitalWrite(this->reset_pin, HIGH);
         delay(5);
+        this->setPowerOnResetValues();
     }
 }
 
@@ -78,44 +186,689 @@ void MCP::setup(uint8_t i2c, uint8_t io, int reset_pin, long i2c_bus_freq) {
     this->reset_pin = reset_pin;
     this->reset();
 
-    Wire.begin(); //creates a Wire object
+    this->bus->begin(); // starts the transport (Wire.begin on Arduino) 
     this->setClock(i2c_bus_freq);
     this->i2cAddress = i2c;
+    this->started = true;
+    if (this->cacheEnabled)
+        this->reloadRegisterCache();     // Seeds the register cache with the current device content
     this->setRegister(REG_IODIR, io);    // All GPIO pins are configured to input (1)  or output (0)
     this->setGPIOS(0);                   // // Sets all port to 0 (LOW)
 }
 
+/**
+ * @ingroup group01
+ * @brief Enables or disables the register cache (write-through shadow registers)
+ * @details When enabled, the MCP object keeps a shadow copy of the registers IODIR ~ OLAT. 
+ * @details The configuration registers (IODIR, IPOL, GPINTEN, DEFVAL, INTCON, IOCON, GPPU and OLAT) are served from this copy 
+ * @details and every write goes to the device and to the copy (write-through). Pin writes are computed from the OLAT shadow register.
+ * @details Only the registers that can change on their own (GPIO, INTF and INTCAP) are read from the device. 
+ * @details It cuts the read-modify-write operations (turnGpioOn, pullUpGpioOn, interruptGpioOn etc) to a single I2C write.
+ * @details Do not change the device registers by other means (other MCU, direct Wire access) while the cache is enabled. If so, call reloadRegisterCache.
+ * @details If you call this method before setup, the cache will be seeded by the setup. 
+ * @param enabled true = enables the register cache; false = disables it
+ * @see reloadRegisterCache
+ */
+void MCP::setRegisterCache(bool enabled) {
+    if (enabled && !this->cacheEnabled && this->started)
+        this->reloadRegisterCache();
+    this->cacheEnabled = enabled;
+}
+
+/**
+ * @ingroup group01
+ * @brief Enables or disables the write elision
+ * @details When enabled, a write that does not change a register (compared with the shadow copy) is not sent to the device. 
+ * @details It also enables the register cache. Examples: turnGpioOn on a pin that is already on, setGPIOS with the current OLAT value.
+ * @details Use setRegister(reg, value, true) to force a write or markDirty / flush to write the registers again.
+ * @param enabled true = enables; false = disables
+ * @see setRegisterCache, flush, markDirty
+ */
+void MCP::setWriteElision(bool enabled) {
+    if (enabled)
+        this->setRegisterCache(true);
+    this->writeElision = enabled;
+}
+
+/**
+ * @ingroup group01
+ * @brief Writes the dirty registers to the device
+ * @details A register is dirty when it was changed during a batch, when its write failed or when it was marked via markDirty.
+ * @details The dirty registers are written in ascending order using the minimum number of sequential bursts. 
+ * @details Blocks separated by up to MCP_BATCH_MAX_GAP clean registers are joined (the clean registers are written again with their current values).
+ * @details If IOCON is dirty, it is written first. 
+ * @return true if all dirty registers were written
+ * @see markDirty, beginBatch, commit
+ */
+bool MCP::flush() {
+    uint8_t iocon, first, last, reg, status;
+    uint8_t aux[MCP_REG_COUNT];
+    bool batching = this->batching;
+
+    if (this->dirty == 0)
+        return true;
+
+    this->batching = false; // the writes below must go to the device
+
+    // The bursts need the address pointer increment (SEQOP = 0)
+    iocon = this->regs[REG_IOCON];
+    if (CHECK_BIT_HIGH(this->dirty, REG_IOCON))
+        this->setRegister(REG_IOCON, iocon & ~IOCON_SEQOP, true);
+    else
+        this->setSequentialOperation(true);
+
+    reg = REG_IODIR;
+    while (reg <= REG_OLAT)
+    {
+        if (!CHECK_BIT_HIGH(this->dirty, reg))
+        {
+            reg++;
+            continue;
+        }
+        // Finds the end of the block, joining dirty registers separated by small gaps
+        first = last = reg;
+        for (reg = first + 1; reg <= REG_OLAT && reg - last <= MCP_BATCH_MAX_GAP + 1; reg++)
+            if (CHECK_BIT_HIGH(this->dirty, reg))
+                last = reg;
+
+        for (uint8_t i = first; i <= last; i++)
+            aux[i - first] = (i == REG_GPIO) ? this->regs[REG_OLAT] : this->regs[i];  // a GPIO write goes to OLAT
+        status = this->busWrite(first, aux, last - first + 1);
+        for (uint8_t i = first; i <= last; i++)
+            this->updateShadow(i, aux[i - first], status == MCP_BUS_OK);
+        reg = last + 1;
+    }
+
+    this->restoreIoCon(iocon);
+    this->batching = batching;
+    return this->dirty == 0;
+}
+
+/**
+ * @ingroup group01
+ * @brief Opens a batch (deferred register and pin changes)
+ * @details Until commit, the writable registers (IODIR, IPOL, GPINTEN, DEFVAL, INTCON, IOCON, GPPU and OLAT / GPIO) are not sent to the device. 
+ * @details They are staged in the shadow copy (the register cache is enabled) and marked as dirty. 
+ * @details The pin and register functions (turnGpioOn, pullUpGpioOn, interruptGpioOn, setRegister etc) can be used as usual. 
+ * @details Several changes on the same register become a single write and the device sees all the pin changes at once.
+ * @details Nothing is sent before commit: readRegisters returns the staged values; writeRepeated and beginGpioStream are refused.
+ * @code
+ *   mcp.beginBatch();
+ *   mcp.setRegister(REG_GPPU, 0B00001111);
+ *   mcp.setRegister(REG_GPINTEN, 0B00001111);
+ *   mcp.setRegister(REG_DEFVAL, 0B00001111);
+ *   mcp.setRegister(REG_INTCON, 0);
+ *   mcp.commit();   // GPINTEN ~ GPPU in a single I2C transaction
+ * @endcode
+ * @see commit, flush
+ */
+void MCP::beginBatch() {
+    this->setRegisterCache(true);
+    this->batching = true;
+}
+
+/**
+ * @ingroup group01
+ * @brief Closes the batch and writes the staged changes
+ * @return true if all staged changes were written
+ * @see beginBatch, flush
+ */
+bool MCP::commit() {
+    this->batching = false;
+    return this->flush();
+}
+
+/**
+ * @ingroup group01
+ * @brief Reloads the register cache from the device
+ * @details Reads IODIR ~ INTF in a sequential read and OLAT in another one, and updates the shadow copy. 
+ * @details INTCAP and GPIO are not read, so a pending interrupt is not cleared.
+ * @details Nothing is done during a batch (the staged changes would be lost).
+ * @see setRegisterCache
+ */
+void MCP::reloadRegisterCache() {
+    uint8_t aux[MCP_REG_COUNT];
+    bool enabled = this->cacheEnabled;
+
+    if (this->batching)
+        return;
+    this->cacheEnabled = false;                   // forces the IOCON to be read from the device
+    if (this->readRegisters(REG_IODIR, aux, REG_INTF + 1) == REG_INTF + 1 && this->readRegisters(REG_OLAT, aux, 1) == 1) // readRegisters updates the shadow copy
+        this->dirty = 0;
+    this->cacheEnabled = enabled;
+}
+
 /** @defgroup group02 MCP23008 IO functions */
 
 /**
  * @ingroup group02
  * @brief Gets the corrent register information. 
  * @details Gets the current register content. 
+ * @details If the register cache is enabled, the configuration registers are served from the shadow copy (no I2C traffic).
+ * @details If the transfer fails, 0xFF is returned (see readRegister to get the bus status).
  * @param reg  (0x00 ~ 0xA) see MCP23008 registers documentation 
  * @return uint8_t current register value
+ * @see setRegisterCache, readRegister
  */
 uint8_t MCP::getRegister(uint8_t reg) {
+    uint8_t value = 0xFF;   // the same value the Wire.read returns (-1) when nothing was received
+
+    this->readRegister(reg, &value);
+    return value;
+}
+
+/**
+ * @ingroup group02
+ * @brief Reads a register and returns the bus status
+ * @details The same as getRegister, but a failed transfer is reported instead of returning 0xFF as a register value.
+ * @code
+ *   uint8_t gpio;
+ *   if (mcp.readRegister(REG_GPIO, &gpio) != MCP_BUS_OK) {
+ *      // gpio was not changed
+ *   }
+ * @endcode
+ * @param reg   (0x00 ~ 0xA) see MCP23008 registers documentation 
+ * @param value receives the register value (not changed if the transfer fails)
+ * @return uint8_t bus status (MCP_BUS_OK = success)
+ */
+uint8_t MCP::readRegister(uint8_t reg, uint8_t *value) {
+    uint8_t aux, status;
+
+    if (this->cacheEnabled && reg <= REG_OLAT && !CHECK_BIT_HIGH(MCP_VOLATILE_REGS, reg))
+    {
+        *value = this->regs[reg];
+        return MCP_BUS_OK;
+    }
+
     // delayMicroseconds(2000);
-    Wire.beginTransmission(this->i2cAddress);
-    Wire.write(reg);
-    Wire.endTransmission();
-    Wire.requestFrom((int) this->i2cAddress, (int) 1); 
-    return Wire.read();
+    status = this->busRead(reg, &aux, 1);
+    if (status != MCP_BUS_OK)
+        return status;
+    if (reg <= REG_OLAT)
+        this->regs[reg] = aux;
+    if (reg == REG_IOCON)
+        this->ioconKnown = true;
+    *value = aux;
+    return MCP_BUS_OK;
+}
+
+/**
+ * @ingroup group02
+ * @brief Records a failed transfer attempt and waits before the next one (retry policy)
+ * @param status bus status of the attempt
+ * @param attempt attempt number (0 = first)
+ * @param write true = write transfer
+ * @return true if the transfer must be repeated
+ * @see setRetryPolicy
+ */
+bool MCP::retryAfter(uint8_t status, uint8_t attempt, bool write) {
+    this->busErrors.lastError = status;
+    if (status == MCP_BUS_VERIFY_ERROR)
+        this->busErrors.verifyErrors++;
+    else if (write)
+        this->busErrors.writeErrors++;
+    else
+        this->busErrors.readErrors++;
+
+    if (status == MCP_BUS_DATA_TOO_LONG || attempt >= this->retries)
+    {
+        this->busErrors.failures++;
+        return false;
+    }
+    this->busErrors.retries++;
+    if (this->backoffUs)
+    {
+        uint32_t wait = (uint32_t)this->backoffUs << ((attempt < 6) ? attempt : 6);
+        delayMicroseconds((wait < MCP_BUS_MAX_BACKOFF_US) ? wait : MCP_BUS_MAX_BACKOFF_US);
+    }
+    return true;
+}
+
+/**
+ * @ingroup group02
+ * @brief Reads back the configuration registers just written (see setVerifyWrites)
+ * @details Only the written registers up to GPPU are read back. INTF, INTCAP and GPIO are never read: reading INTCAP or GPIO clears the interrupt.
+ * @param reg   first register written
+ * @param data  values written
+ * @param n     number of bytes written
+ * @return uint8_t MCP_BUS_OK, MCP_BUS_VERIFY_ERROR or the status of the read
+ */
+uint8_t MCP::verifyWrite(uint8_t reg, const uint8_t *data, uint8_t n) {
+    uint8_t buf[MCP_REG_COUNT], status;
+
+    if (reg > REG_GPPU || n == 0)
+        return MCP_BUS_OK;
+    if (n > REG_GPPU - reg + 1)
+        n = REG_GPPU - reg + 1;
+    if (n > 1 && ((this->regs[REG_IOCON] & IOCON_SEQOP) || (reg <= REG_IOCON && REG_IOCON < reg + n)))
+        return MCP_BUS_OK;   // the read back would not see the same registers
+
+    status = this->bus->readRegisters(this->i2cAddress, reg, buf, n);
+    if (status != MCP_BUS_OK)
+        return status;
+    for (uint8_t i = 0; i < n; i++)
+    {
+        uint8_t mask = (reg + i == REG_IOCON) ? 0x3E : 0xFF;  // IOCON bits 0, 6 and 7 are unimplemented (read as 0)
+        if (CHECK_BIT_HIGH(MCP_VERIFY_REGS, (reg + i)) && (buf[i] & mask) != (data[i] & mask))
+            return MCP_BUS_VERIFY_ERROR;
+    }
+    return MCP_BUS_OK;
+}
+
+/**
+ * @ingroup group02
+ * @brief Writes n bytes starting at a given register via the current transport
+ * @details All device writes go through this method. n = 0 moves the device address pointer only.
+ * @details Failed writes are repeated according to the retry policy (see setRetryPolicy) and read back if setVerifyWrites is enabled.
+ * @param reg   first register
+ * @param data  values
+ * @param n     number of bytes
+ * @return uint8_t bus status
+ */
+uint8_t MCP::busWrite(uint8_t reg, const uint8_t *data, uint8_t n) {
+    uint8_t status;
+
+    for (uint8_t attempt = 0;; attempt++)
+    {
+        status = this->bus->writeRegisters(this->i2cAddress, reg, data, n);
+        if (status == MCP_BUS_OK && this->verifyWrites)
+            status = this->verifyWrite(reg, data, n);
+        if (status == MCP_BUS_OK || !this->retryAfter(status, attempt, true))
+            break;
+    }
+    // in stream mode (SEQOP = 1) a GPIO write keeps the address pointer on GPIO
+    this->gpioStreamParked = this->gpioStream && reg == REG_GPIO && status == MCP_BUS_OK;
+    return status;
+}
+
+/**
+ * @ingroup group02
+ * @brief Reads n bytes starting at a given register via the current transport
+ * @details All device register reads go through this method. Failed reads are repeated according to the retry policy (see setRetryPolicy),
+ * @details except the reads of INTCAP or GPIO: the failed attempt may have cleared the interrupt on the device.
+ * @param reg   first register
+ * @param data  buffer
+ * @param n     number of bytes
+ * @return uint8_t bus status
+ */
+uint8_t MCP::busRead(uint8_t reg, uint8_t *data, uint8_t n) {
+    uint8_t status;
+    bool clearsInterrupt = reg <= REG_GPIO && reg + n > REG_INTCAP;  // INTCAP or GPIO in the range
+
+    this->gpioStreamParked = false;
+    for (uint8_t attempt = 0;; attempt++)
+    {
+        status = this->bus->readRegisters(this->i2cAddress, reg, data, n);
+        if (status == MCP_BUS_OK || !this->retryAfter(status, (clearsInterrupt) ? this->retries : attempt, false))
+            break;
+    }
+    return status;
+}
+
+/**
+ * @ingroup group02
+ * @brief Reads n bytes from the current device address pointer via the current transport
+ * @param data  buffer
+ * @param n     number of bytes
+ * @return uint8_t bus status
+ */
+uint8_t MCP::busReadCurrent(uint8_t *data, uint8_t n) {
+    uint8_t status = this->bus->readCurrent(this->i2cAddress, data, n);
+
+    if (status != MCP_BUS_OK)
+        this->retryAfter(status, this->retries, false);  // not repeated: the address pointer position is not known after a failure
+    return status;
+}
+
+/**
+ * @ingroup group02
+ * @brief Updates the shadow copy of a given register after a write operation
+ * @details Writing to GPIO modifies the OLAT register. INTF and INTCAP are read-only.
+ * @param reg   register 
+ * @param value value written
+ * @param committed false if the device did not acknowledge the write (the register becomes dirty)
+ */
+void MCP::updateShadow(uint8_t reg, uint8_t value, bool committed) {
+    uint8_t target = (reg == REG_GPIO) ? REG_OLAT : reg;
+
+    if (reg > REG_OLAT || reg == REG_INTF || reg == REG_INTCAP)
+        return;
+    this->regs[reg] = value;
+    this->regs[target] = value;
+    if (target == REG_IOCON)
+        this->ioconKnown = committed;
+    if (committed)
+        this->dirty &= ~(1 << target);
+    else
+        this->dirty |= (1 << target);
 }
 
 /**
  * @ingroup group02
  * @brief Sets a value to a given register
  * @details Sets a given 8 bit value to a given register.  
+ * @details If the write elision is enabled (see setWriteElision), nothing is sent when the register already has the value.
+ * @param reg   (0x00 ~ 0xA) see MCP23008 registers documentation 
+ * @param value value (8 bits)
+ * @param force if true, the value is sent even if the register already has it (default false)
+ * @see writeRegister
+ */
+void MCP::setRegister(uint8_t reg, uint8_t value, bool force) {
+    this->writeRegister(reg, value, force);
+}
+
+/**
+ * @ingroup group02
+ * @brief Sets a value to a given register and returns the bus status
+ * @details The same as setRegister. A write that is elided or staged in a batch returns MCP_BUS_OK.
+ * @details If the write fails, the register becomes dirty (the next flush writes it again).
  * @param reg   (0x00 ~ 0xA) see MCP23008 registers documentation 
  * @param value value (8 bits)
+ * @param force if true, the value is sent even if the register already has it (default false)
+ * @return uint8_t bus status (MCP_BUS_OK = success; MCP_BUS_VERIFY_ERROR = the read back value is different)
  */
-void MCP::setRegister(uint8_t reg, uint8_t value) {
+uint8_t MCP::writeRegister(uint8_t reg, uint8_t value, bool force) {
+    uint8_t target = (reg == REG_GPIO) ? REG_OLAT : reg;
+    uint8_t status;
+
+    if (this->writeElision && this->cacheEnabled && !force && CHECK_BIT_HIGH(MCP_WRITABLE_REGS, target) 
+        && !CHECK_BIT_HIGH(this->dirty, target) && this->regs[target] == value)
+        return MCP_BUS_OK;   // the device already has this value (avoid trafic on I2C)
+
+    if (this->batching && CHECK_BIT_HIGH(MCP_WRITABLE_REGS, target))
+    {
+        this->updateShadow(reg, value, false); // staged until commit
+        return MCP_BUS_OK;
+    }
+
     // delayMicroseconds(2000);
-    Wire.beginTransmission(this->i2cAddress);
-    Wire.write(reg);
-    Wire.write(value);
-    Wire.endTransmission(); //ends communication with the device
+    status = this->busWrite(reg, &value, 1);
+
+    this->updateShadow(reg, value, status == MCP_BUS_OK); // Keeps the shadow copy updated (write-through)
+    return status;
+}
+
+/**
+ * @ingroup group02
+ * @brief Sets the Sequential Operation mode (IOCON SEQOP bit)
+ * @details Changes the IOCON register only if the SEQOP bit is not in the given state. 
+ * @details The IOCON value comes from the shadow copy when it is known (register cache enabled, or IOCON already read / written). 
+ * @details Otherwise, it is read from the device once.
+ * @param enabled true = the address pointer increments after each byte (SEQOP = 0); false = the address pointer does not increment (SEQOP = 1)
+ * @return uint8_t the IOCON value before the change. Use restoreIoCon to go back to it.
+ * @see restoreIoCon
+ */
+uint8_t MCP::setSequentialOperation(bool enabled) {
+    uint8_t iocon = (this->cacheEnabled || this->ioconKnown) ? this->regs[REG_IOCON] : this->getRegister(REG_IOCON);
+    uint8_t aux = (enabled) ? (iocon & ~IOCON_SEQOP) : (iocon | IOCON_SEQOP);
+    if ( aux != iocon )
+        this->setRegister(REG_IOCON, aux);
+    return iocon;
+}
+
+/**
+ * @ingroup group02
+ * @brief Restores the IOCON register if it was changed by setSequentialOperation
+ * @param iocon the IOCON value returned by setSequentialOperation
+ * @see setSequentialOperation
+ */
+void MCP::restoreIoCon(uint8_t iocon) {
+    if (this->regs[REG_IOCON] != iocon)
+        this->setRegister(REG_IOCON, iocon);
+}
+
+/**
+ * @ingroup group02
+ * @brief Reads a block of consecutive registers in a single I2C transaction
+ * @details Uses the MCP23008 Sequential Operation mode (address pointer auto-increment). 
+ * @details If SEQOP is disabled (IOCON), it is enabled during the transfer and restored after that.
+ * @details During a batch (see beginBatch), the configuration registers come from the batch (staged values) and only INTF, INTCAP and GPIO 
+ * @details are read from the device, one by one (the device IOCON may be different from the staged one). Nothing is committed.
+ * @details Outside a batch, the shadow copy of a dirty register (see flush) is not replaced by the value read.
+ * @details Example: a full register snapshot in one transaction.
+ * @code
+ *   uint8_t r[MCP_REG_COUNT];
+ *   mcp.readRegisters(REG_IODIR, r, MCP_REG_COUNT);
+ * @endcode
+ * @param startReg  first register (0x00 ~ 0xA)
+ * @param buf       buffer that will receive the register values
+ * @param n         number of registers to read (limited to the last register - REG_OLAT)
+ * @return uint8_t  number of registers read
+ */
+uint8_t MCP::readRegisters(uint8_t startReg, uint8_t *buf, uint8_t n) {
+    uint8_t iocon, count;
+
+    if (startReg > REG_OLAT)
+        return 0;
+    if (n > MCP_REG_COUNT - startReg)
+        n = MCP_REG_COUNT - startReg;
+
+    if (this->batching)
+    {   // staged registers from the shadow copy; volatile registers from the device
+        for (count = 0; count < n; count++)
+            if (this->readRegister(startReg + count, &buf[count]) != MCP_BUS_OK)
+                break;
+        return count;
+    }
+
+    iocon = this->setSequentialOperation(true);
+
+    count = (this->busRead(startReg, buf, n) == MCP_BUS_OK) ? n : 0;
+    for (uint8_t i = 0; i < count; i++)
+        if (!CHECK_BIT_HIGH(this->dirty, (startReg + i)))   // a dirty register keeps the value the next flush writes
+            this->regs[startReg + i] = buf[i];
+    if (startReg <= REG_IOCON && REG_IOCON < startReg + count)
+        this->ioconKnown = true;
+
+    this->restoreIoCon(iocon);
+    if (startReg <= REG_IOCON && REG_IOCON < startReg + count)
+        buf[REG_IOCON - startReg] = iocon;  // reports the IOCON value the device has after the transfer
+    return count;
+}
+
+/**
+ * @ingroup group02
+ * @brief Writes a block of consecutive registers in a single I2C transaction
+ * @details Uses the MCP23008 Sequential Operation mode (address pointer auto-increment). 
+ * @details If SEQOP is disabled (IOCON), it is enabled during the transfer and restored after that.
+ * @details If the block includes IOCON, the SEQOP bit is kept clear during the transfer and the IOCON value of the buffer is written at the end (if needed).
+ * @details Writing to INTF and INTCAP (read-only registers) has no effect. Writing to GPIO modifies the OLAT register.
+ * @details During a batch (see beginBatch), the values are staged until commit.
+ * @code
+ *   // IODIR, IPOL, GPINTEN, DEFVAL, INTCON, IOCON and GPPU in one transaction
+ *   uint8_t r[] = {0B00001111, 0, 0B00001111, 0B00001111, 0, 0, 0B00001111};
+ *   mcp.writeRegisters(REG_IODIR, r, 7);
+ * @endcode
+ * @param startReg  first register (0x00 ~ 0xA)
+ * @param buf       register values
+ * @param n         number of registers to write (limited to the last register - REG_OLAT)
+ * @return uint8_t  number of registers written (0 if the device did not acknowledge)
+ */
+uint8_t MCP::writeRegisters(uint8_t startReg, const uint8_t *buf, uint8_t n) {
+    uint8_t iocon, status;
+    uint8_t aux[MCP_REG_COUNT];
+
+    if (startReg > REG_OLAT)
+        return 0;
+    if (n > MCP_REG_COUNT - startReg)
+        n = MCP_REG_COUNT - startReg;
+
+    if (this->batching)
+    {   // staged until commit
+        for (uint8_t i = 0; i < n; i++)
+            this->setRegister(startReg + i, buf[i]);
+        return n;
+    }
+
+    iocon = this->setSequentialOperation(true);
+
+    for (uint8_t i = 0; i < n; i++)
+    {
+        aux[i] = buf[i];
+        if (startReg + i == REG_IOCON)
+        {
+            iocon = aux[i];          // the IOCON value wanted after the transfer
+            aux[i] &= ~IOCON_SEQOP;  // keeps the address pointer incrementing during the transfer
+        }
+    }
+    status = this->busWrite(startReg, aux, n);
+    for (uint8_t i = 0; i < n; i++)
+        this->updateShadow(startReg + i, aux[i], status == MCP_BUS_OK);
+
+    this->restoreIoCon(iocon);
+    return (status == 0) ? n : 0;
+}
+
+/**
+ * @ingroup group02
+ * @brief Writes n values to the same register in a single I2C transaction
+ * @details The Sequential Operation is disabled (IOCON SEQOP = 1) during the transfer, so the address pointer does not move and each byte 
+ * @details overwrites the register. The device outputs follow each byte (one byte time each). Useful for strobes and bit-banged waveforms on GPIO / OLAT.
+ * @details The IOCON register is restored after the transfer. In GPIO stream mode (see beginGpioStream) SEQOP is already 1 and nothing else is sent.
+ * @details Transfers longer than the transport buffer are split in more than one transaction.
+ * @details Not allowed during a batch (see beginBatch): nothing is written and 0 is returned.
+ * @code
+ *   uint8_t strobe[] = {0x0A, 0x8A, 0x0A};   // data, data + GPIO7 high, data
+ *   mcp.writeRepeated(REG_GPIO, strobe, 3);
+ * @endcode
+ * @param reg  register (GPIO or OLAT)
+ * @param buf  values
+ * @param n    number of values
+ * @return uint8_t number of values written
+ */
+uint8_t MCP::writeRepeated(uint8_t reg, const uint8_t *buf, uint8_t n) {
+    uint8_t iocon, chunk, count = 0;
+
+    if (reg > REG_OLAT || reg == REG_IOCON || this->batching)
+        return 0;
+
+    iocon = this->setSequentialOperation(false);
+    while (count < n)
+    {
+        chunk = (n - count > MCP_I2C_BUFFER_LENGTH - 1) ? MCP_I2C_BUFFER_LENGTH - 1 : n - count;
+        if (this->busWrite(reg, buf + count, chunk) != MCP_BUS_OK)
+            break;
+        count += chunk;
+    }
+    if (count > 0)
+        this->updateShadow(reg, buf[count - 1]);
+    this->restoreIoCon(iocon);
+    return count;
+}
+
+/**
+ * @ingroup group02
+ * @brief Starts the GPIO stream (high-rate polling) mode
+ * @details Disables the Sequential Operation (IOCON SEQOP = 1) and parks the device address pointer on REG_GPIO. 
+ * @details After that, readGpioSamples and getGPIOS just read bytes from the device (no register address write phase). 
+ * @details Other register operations are still allowed. They move the address pointer and the next read parks it again on REG_GPIO.
+ * @details Do not enable the Sequential Operation (SEQOP) while in stream mode.  
+ * @details Not allowed during a batch (see beginBatch): commit first.
+ * @return true if the stream mode is on; false if a batch is open
+ * @see readGpioSamples, endGpioStream
+ */
+bool MCP::beginGpioStream() {
+    if (this->batching)
+        return false;
+    if (!this->gpioStream)
+        this->streamIoCon = this->setSequentialOperation(false);
+    this->gpioStream = true;
+    this->gpioStreamParked = false;
+    return true;
+}
+
+/**
+ * @ingroup group02
+ * @brief Reads n samples of the GPIO register 
+ * @details In stream mode (see beginGpioStream), reads n bytes from the device in a single I2C read. Each byte is a GPIO sample. 
+ * @details Transfers longer than MCP_I2C_BUFFER_LENGTH are split in more than one read (Arduino Wire).
+ * @details Out of the stream mode, each sample is read via getRegister.
+ * @code
+ *   uint8_t samples[16];
+ *   mcp.beginGpioStream();
+ *   mcp.readGpioSamples(samples, 16);
+ * @endcode
+ * @param buf buffer that will receive the GPIO samples
+ * @param n   number of samples
+ * @return uint8_t number of samples read
+ */
+uint8_t MCP::readGpioSamples(uint8_t *buf, uint8_t n) {
+    uint8_t count = 0;
+
+    if (!this->gpioStream)
+    {
+        for (; count < n; count++)
+            buf[count] = this->getRegister(REG_GPIO);
+        return count;
+    }
+
+    if (!this->gpioStreamParked)
+    {   // Moves the address pointer to GPIO. SEQOP = 1 keeps it there.
+        if (this->busWrite(REG_GPIO, 0, 0) != MCP_BUS_OK)
+            return 0;
+        this->gpioStreamParked = true;
+    }
+
+    if (this->busReadCurrent(buf, n) == MCP_BUS_OK)
+        count = n;
+    if (count > 0)
+        this->gpios = this->regs[REG_GPIO] = buf[count - 1];
+    return count;
+}
+
+/**
+ * @ingroup group02
+ * @brief Stops the GPIO stream mode
+ * @details Restores the IOCON register (SEQOP) to the value it had before beginGpioStream.
+ * @see beginGpioStream
+ */
+void MCP::endGpioStream() {
+    if (!this->gpioStream)
+        return;
+    this->gpioStream = false;
+    this->restoreIoCon(this->streamIoCon);
+}
+
+/**
+ * @ingroup group02
+ * @brief Reads INTF and INTCAP in a single I2C transaction
+ * @details Both values come from the same sequential read, so they always refer to the same interrupt. Reading INTCAP clears the interrupt.
+ * @details If the device IOCON is not known (register cache disabled and IOCON never read / written), the read starts at IOCON 
+ * @details (IOCON, GPPU, INTF and INTCAP): the IOCON byte shows if the address pointer incremented. Still one transaction.
+ * @details Only with the Sequential Operation disabled (IOCON SEQOP = 1), INTF and INTCAP are read in two transactions (IOCON is not changed).
+ * @param intf   receives the INTF value (pins that caused the interrupt)
+ * @param intcap receives the INTCAP value (GPIO value at the time the interrupt occurred)
+ * @return true if the registers were read
+ */
+bool MCP::getInterruptCapture(uint8_t *intf, uint8_t *intcap) {
+    uint8_t aux[4];
+    uint8_t *capture = aux;
+    uint8_t iocon = this->regs[REG_IOCON];
+
+    if (CHECK_BIT_HIGH(this->dirty, REG_IOCON) || !(this->cacheEnabled || this->ioconKnown))
+    {   // the device IOCON is not known (or differs from the staged value)
+        if (this->busRead(REG_IOCON, aux, 4) != MCP_BUS_OK)
+            return false;
+        iocon = aux[0];
+        capture = &aux[REG_INTF - REG_IOCON];
+        if (!CHECK_BIT_HIGH(this->dirty, REG_IOCON))
+        {
+            this->regs[REG_IOCON] = iocon;
+            this->ioconKnown = true;
+        }
+    }
+    else if (!(iocon & IOCON_SEQOP) && this->busRead(REG_INTF, aux, 2) != MCP_BUS_OK)
+        return false;
+
+    if (iocon & IOCON_SEQOP)
+    {   // the address pointer does not increment
+        capture = aux;
+        if (this->busRead(REG_INTF, &aux[0], 1) != MCP_BUS_OK || this->busRead(REG_INTCAP, &aux[1], 1) != MCP_BUS_OK)
+            return false;
+    }
+    *intf = this->intf = this->regs[REG_INTF] = capture[0];
+    *intcap = this->intcap = this->regs[REG_INTCAP] = capture[1];
+    return true;
 }
 
 
@@ -127,13 +880,13 @@ void MCP::setRegister(uint8_t reg, uint8_t value) {
  */
 void MCP::turnGpioOn(uint8_t gpio)
 {
-    // Checks if it is already ON (avoid trafic on I2C)
+    // If it is already ON, the write elision avoids trafic on I2C (see setWriteElision)
     if ( gpio > 7 )
         return;
 
     uint8_t b = (1 << gpio);
 
-    gpios = this->getGPIOS() | b;
+    gpios = this->getOutputLatch() | b;
     this->setGPIOS(gpios);
 }
 
@@ -149,7 +902,7 @@ void MCP::turnGpioOff(uint8_t gpio)
     if (gpio > 7)
         return;
     uint8_t b = (1 << gpio);    
-    gpios = this->getGPIOS() & ~b;
+    gpios = this->getOutputLatch() & ~b;
     this->setGPIOS(gpios);
 }
 
@@ -162,7 +915,7 @@ void MCP::turnGpioOff(uint8_t gpio)
  */
 bool MCP::gpioRead(uint8_t gpio) {
     if (gpio > 7) return false;
-    return getRegister(REG_GPIO) & (1 << gpio);
+    return this->getGPIOS() & (1 << gpio);
 }
 
 /**
@@ -175,8 +928,8 @@ bool MCP::gpioRead(uint8_t gpio) {
 void MCP::gpioWrite(uint8_t gpio, uint8_t value) {
     if (gpio > 7)
         return;
-    uint8_t currentGpio = this->getRegister(REG_GPIO) ;
-    this->setRegister(REG_GPIO, (currentGpio & ~(1 << 2)) | (value << gpio) );
+    uint8_t currentGpio = this->getOutputLatch();
+    this->setRegister(REG_GPIO, (currentGpio & ~(1 << gpio)) | ((value) ? (1 << gpio) : 0));
 }
 
 /**
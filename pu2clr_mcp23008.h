@@ -17,8 +17,15 @@
  * @copyright Copyright (c) 2021 Ricardo Lima Caratti
  */
 
+#ifndef _PU2CLR_MCP23008_H
+#define _PU2CLR_MCP23008_H
+
+#if defined(ARDUINO)
 #include <Arduino.h>
 #include <Wire.h>
+#else
+#include "pu2clr_mcp23008_host.h"   // Non Arduino (Linux host) build
+#endif
 
 // registers
 #define REG_IODIR 0x00   //!< Controls the direction of the data I/O. When  a  bit  is  set,  the  corresponding  pin  becomes  an input.  When  a  bit  is  clear,  the  corresponding  pin becomes an output.
@@ -33,6 +40,52 @@
 #define REG_GPIO 0x09    //!< The GPIO  register  reflects  the  value  on  the  port.
 #define REG_OLAT 0x0A    //!< The OLAT  register  provides  access  to  the  output latches.
 
+#define MCP_REG_COUNT 11 //!< Number of MCP23008 registers (REG_IODIR ~ REG_OLAT)
+#define MCP_VOLATILE_REGS ((1 << REG_INTF) | (1 << REG_INTCAP) | (1 << REG_GPIO)) //!< Registers that can change on their own (never served from the register cache)
+#define MCP_WRITABLE_REGS (0x07FF & ~MCP_VOLATILE_REGS) //!< Registers kept by the register cache and the write elision (a GPIO write is an OLAT write)
+
+#define IOCON_SEQOP 0x20 //!< IOCON SEQOP bit mask. 1 = Sequential operation disabled, address pointer does not increment.
+#define IOCON_DISSLW 0x10 //!< IOCON DISSLW bit mask. 1 = Slew rate disabled (SDA output; no function on the MCP23S08).
+#define IOCON_HAEN 0x08  //!< IOCON HAEN bit mask (MCP23S08 only). 1 = The hardware address pins (A1, A0) are enabled.
+
+#ifndef MCP_I2C_BUFFER_LENGTH
+#define MCP_I2C_BUFFER_LENGTH 32 //!< Maximum number of bytes per I2C read (Arduino Wire buffer size)
+#endif
+
+// Bus status codes (the same values returned by the Arduino Wire.endTransmission)
+#define MCP_BUS_OK 0             //!< Success
+#define MCP_BUS_DATA_TOO_LONG 1  //!< Data too long to fit in the transmit buffer
+#define MCP_BUS_NACK_ADDRESS 2   //!< Received NACK on transmit of address
+#define MCP_BUS_NACK_DATA 3      //!< Received NACK on transmit of data
+#define MCP_BUS_ERROR 4          //!< Other error
+#define MCP_BUS_TIMEOUT 5        //!< Timeout
+#define MCP_BUS_SHORT_READ 6     //!< The device returned less bytes than requested
+#define MCP_BUS_VERIFY_ERROR 7   //!< The value read back is not the value written (see setVerifyWrites)
+
+#ifndef MCP_BUS_RETRIES
+#define MCP_BUS_RETRIES 0        //!< Default number of retries of a failed transfer (0 = no retry; see setRetryPolicy)
+#endif
+
+#ifndef MCP_BUS_BACKOFF_US
+#define MCP_BUS_BACKOFF_US 100   //!< Default wait (us) before the first retry. It doubles at each new retry.
+#endif
+
+#define MCP_BUS_MAX_BACKOFF_US 16383 //!< Longest wait before a retry (the largest accurate delayMicroseconds value on AVR)
+
+#define MCP_VERIFY_REGS 0x007F   //!< Registers checked by the verify-after-write: IODIR, IPOL, GPINTEN, DEFVAL, INTCON, IOCON and GPPU
+
+#ifndef MCP_MEMORY_BARRIER
+#if defined(__AVR__)
+#define MCP_MEMORY_BARRIER() __asm__ __volatile__("" ::: "memory") //!< single core: a compiler barrier is enough
+#else
+#define MCP_MEMORY_BARRIER() __sync_synchronize()                  //!< full memory barrier (multi-core MCUs and Linux)
+#endif
+#endif
+
+#ifndef MCP_BATCH_MAX_GAP
+#define MCP_BATCH_MAX_GAP 2 //!< Maximum number of clean registers rewritten to join two dirty register blocks in a single burst (cheaper than a new transaction)
+#endif
+
 #define GPIO_INPUT 0xFF
 #define GPIO_OUTPUT 0x00
 
@@ -72,22 +125,164 @@ typedef union
    uint8_t raw;
 } mcp23008_ioncon;
 
+/**
+ * @brief Bus error statistics of a device (see MCP::getBusErrors)
+ * @details A growing number of retries or failures usually means a long / noisy bus: lower the I2C clock.
+ */
+typedef struct
+{
+   uint16_t writeErrors;  //!< failed write attempts
+   uint16_t readErrors;   //!< failed read attempts
+   uint16_t verifyErrors; //!< writes whose read back value was different (see MCP::setVerifyWrites)
+   uint16_t retries;      //!< attempts repeated by the retry policy
+   uint16_t failures;     //!< transfers that failed after all attempts
+   uint8_t lastError;     //!< last bus status different from MCP_BUS_OK
+} mcp23008_bus_errors;
+
+/**
+ * @brief Transport (bus) interface used by the MCP class
+ * @details It decouples the MCP class from the Arduino Wire object. The default transport is the MCPWireBus (Arduino Wire). 
+ * @details Other transports (Linux i2c-dev, simulated MCP23008 etc) can be selected via MCP::setBus.
+ * @details All methods return a bus status code (MCP_BUS_OK = 0 on success). 
+ * @details The address is the 7 bit device address (0x20 ~ 0x27). The register address is sent before the data.
+ */
+class MCPBus
+{
+public:
+   /**
+    * @brief Starts the bus 
+    */
+   virtual void begin() {};
+
+   /**
+    * @brief Sets the bus clock (when the transport supports it)
+    * @param freq frequency in Hz
+    */
+   virtual void setClock(long freq) { (void) freq; };
+
+   /**
+    * @brief Checks if the bus is busy
+    * @details A transport that runs the transfers in background (DMA, interrupt driven or shared with other masters) returns true 
+    * @details while a new transfer cannot be started. The blocking transports are never busy.
+    * @return true if a new transfer cannot be started now
+    */
+   virtual bool isBusy() { return false; };
+
+   /**
+    * @brief Checks if there is a device at a given address
+    * @param address device address
+    * @return uint8_t MCP_BUS_OK if the device acknowledges
+    */
+   virtual uint8_t probe(uint8_t address) = 0;
+
+   /**
+    * @brief Writes n bytes starting at a given register 
+    * @details n = 0 just moves the device address pointer to reg.
+    * @param address device address
+    * @param reg first register
+    * @param data values 
+    * @param n number of bytes
+    * @return uint8_t bus status
+    */
+   virtual uint8_t writeRegisters(uint8_t address, uint8_t reg, const uint8_t *data, uint8_t n) = 0;
+
+   /**
+    * @brief Reads n bytes starting at a given register
+    * @param address device address
+    * @param reg first register
+    * @param data buffer 
+    * @param n number of bytes
+    * @return uint8_t bus status
+    */
+   virtual uint8_t readRegisters(uint8_t address, uint8_t reg, uint8_t *data, uint8_t n) = 0;
+
+   /**
+    * @brief Reads n bytes from the current device address pointer (no register address write phase)
+    * @param address device address
+    * @param data buffer 
+    * @param n number of bytes
+    * @return uint8_t bus status
+    */
+   virtual uint8_t readCurrent(uint8_t address, uint8_t *data, uint8_t n) = 0;
+
+   virtual ~MCPBus() {};
+};
+
+#if defined(ARDUINO)
+/**
+ * @brief MCPBus implementation based on the Arduino Wire object
+ * @details It is the default transport of the MCP class on Arduino boards.
+ */
+class MCPWireBus : public MCPBus
+{
+protected:
+   TwoWire *wire;
+   bool started = false;
+
+public:
+   MCPWireBus(TwoWire *wire = &Wire) : wire(wire) {};
+   void begin();
+   void setClock(long freq);
+   uint8_t probe(uint8_t address);
+   uint8_t writeRegisters(uint8_t address, uint8_t reg, const uint8_t *data, uint8_t n);
+   uint8_t readRegisters(uint8_t address, uint8_t reg, uint8_t *data, uint8_t n);
+   uint8_t readCurrent(uint8_t address, uint8_t *data, uint8_t n);
+};
+#endif
+
 class MCP
 {
 
 protected:
+   MCPBus *bus = MCP::defaultBus(); //!< Transport (Arduino Wire by default)
    uint8_t i2cAddress = 0x20; //!< Default i2c address
    uint8_t gpios = 0;         //!< REG_GPIO shadow register
    uint8_t intcap = 0;
    uint8_t intf = 0;
    int reset_pin =  -1;       //!< Digital Arduino pin to control the MCP2300 RESET
+   uint8_t regs[MCP_REG_COUNT] = {0xFF, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}; //!< Shadow copy of the registers IODIR ~ OLAT (see setRegisterCache)
+   bool cacheEnabled = false; //!< If true, the configuration registers are served from the shadow copy
+   bool started = false;      //!< true after setup()
+   bool gpioStream = false;   //!< true between beginGpioStream and endGpioStream
+   bool gpioStreamParked = false; //!< true if the device address pointer is known to be on REG_GPIO
+   uint8_t streamIoCon = 0;   //!< IOCON value before beginGpioStream
+   bool writeElision = false; //!< If true, writes that do not change a register are dropped (see setWriteElision)
+   uint16_t dirty = 0;        //!< Registers whose shadow value is not known to be in the device (bit n = register n)
+   bool batching = false;     //!< true between beginBatch and commit
+   bool ioconKnown = false;   //!< true if regs[REG_IOCON] has the device IOCON value (even with the register cache disabled)
+   bool verifyWrites = false; //!< If true, the configuration registers are read back after each write (see setVerifyWrites)
+   uint8_t retries = MCP_BUS_RETRIES;        //!< retries of a failed transfer (see setRetryPolicy)
+   uint16_t backoffUs = MCP_BUS_BACKOFF_US;  //!< wait before the first retry (us)
+   mcp23008_bus_errors busErrors = {0, 0, 0, 0, 0, MCP_BUS_OK}; //!< bus error statistics
+
+   /**
+    * @brief Returns the current output latch value
+    * @details When the register cache is enabled, the value comes from the OLAT shadow register (no I2C traffic). Otherwise, it reads the GPIO register.
+    * @return uint8_t
+    */
+   inline uint8_t getOutputLatch()
+   {
+      return (this->cacheEnabled) ? this->regs[REG_OLAT] : this->getGPIOS();
+   };
+
+   uint8_t busWrite(uint8_t reg, const uint8_t *data, uint8_t n);
+   uint8_t busRead(uint8_t reg, uint8_t *data, uint8_t n);
+   uint8_t busReadCurrent(uint8_t *data, uint8_t n);
+   uint8_t verifyWrite(uint8_t reg, const uint8_t *data, uint8_t n);
+   bool retryAfter(uint8_t status, uint8_t attempt, bool write);
+   void updateShadow(uint8_t reg, uint8_t value, bool committed = true);
+   uint8_t setSequentialOperation(bool enabled);
+   void restoreIoCon(uint8_t iocon);
 
 public:
+   static MCPBus *defaultBus();
    uint8_t lookForDevice(); 
    void reset();
    void setup(uint8_t i2c = 0x20, uint8_t io = GPIO_OUTPUT, int reset_pint = -1, long i2c_freq = 100000);
    uint8_t getRegister(uint8_t reg);
-   void setRegister(uint8_t reg, uint8_t value);
+   void setRegister(uint8_t reg, uint8_t value, bool force = false);
+   uint8_t readRegister(uint8_t reg, uint8_t *value);
+   uint8_t writeRegister(uint8_t reg, uint8_t value, bool force = false);
    void turnGpioOn(uint8_t gpio);
    void turnGpioOff(uint8_t gpio);
    void pullUpGpioOn(uint8_t gpio);
@@ -101,16 +296,156 @@ public:
    void gpioWrite(uint8_t gpio, uint8_t value);
    bool registerDigitalRead(uint8_t mcp_register, uint8_t bit_position);
    void registerDigitalWrite(uint8_t mcp_register, uint8_t bit_position, uint8_t value);
+   void setRegisterCache(bool enabled);
+   void reloadRegisterCache();
+   void setWriteElision(bool enabled);
+   bool flush();
+   void beginBatch();
+   bool commit();
+
+   /**
+    * @ingroup group01
+    * @brief Sets the shadow copy of the registers to the Power-on Reset values (IODIR = 0xFF; all other registers = 0)
+    * @details Called after a reset of the device. Use it if the device is reset by other means (Example: MCPAsync::reset).
+    */
+   inline void setPowerOnResetValues()
+   {
+      memset(this->regs, 0, sizeof(this->regs));
+      this->regs[REG_IODIR] = 0xFF;
+      this->ioconKnown = true;
+      this->gpioStreamParked = false;
+   };
+
+   /**
+    * @ingroup group01
+    * @brief Checks if a batch is open
+    * @see beginBatch
+    * @return true between beginBatch and commit
+    */
+   inline bool isBatching() { return this->batching; };
+
+   /**
+    * @ingroup group01
+    * @brief Marks registers as dirty
+    * @details The next flush writes them again, even if the shadow copy did not change. 
+    * @details Useful if the device may have lost its content (brown-out, reset not controlled by this library).
+    * @param mask bit n = register n (default: all writable registers)
+    * @see flush
+    */
+   inline void markDirty(uint16_t mask = MCP_WRITABLE_REGS) { this->dirty |= (mask & MCP_WRITABLE_REGS); };
+
+   /**
+    * @ingroup group01
+    * @brief Returns the registers whose shadow value is not known to be in the device
+    * @return uint16_t bit n = register n 
+    */
+   inline uint16_t getDirtyRegisters() { return this->dirty; };
+   uint8_t readRegisters(uint8_t startReg, uint8_t *buf, uint8_t n);
+   uint8_t writeRegisters(uint8_t startReg, const uint8_t *buf, uint8_t n);
+   uint8_t writeRepeated(uint8_t reg, const uint8_t *buf, uint8_t n);
+   bool beginGpioStream();
+   uint8_t readGpioSamples(uint8_t *buf, uint8_t n);
+   void endGpioStream();
+
+   /**
+    * @ingroup group01
+    * @brief Checks if the register cache is enabled
+    * @see setRegisterCache
+    * @return true if the register cache is enabled
+    */
+   inline bool isRegisterCacheEnabled() { return this->cacheEnabled; };
+
+   /**
+    * @ingroup group02
+    * @brief Sets the retry policy of the transfers
+    * @details A failed transfer is repeated up to retries times. The wait before a retry starts at backoffUs and doubles at each new retry
+    * @details (up to MCP_BUS_MAX_BACKOFF_US). By default there is no retry (MCP_BUS_RETRIES = 0).
+    * @details Retries are counted in the bus error statistics (see getBusErrors). Reads from the current address pointer (GPIO stream) are not repeated.
+    * @details Reads of INTCAP or GPIO are not repeated either: the failed attempt may have cleared the interrupt on the device (the capture would be lost).
+    * @param retries number of retries (0 = no retry)
+    * @param backoffUs wait (us) before the first retry (0 = no wait)
+    */
+   inline void setRetryPolicy(uint8_t retries, uint16_t backoffUs = MCP_BUS_BACKOFF_US)
+   {
+      this->retries = retries;
+      this->backoffUs = backoffUs;
+   };
+
+   /**
+    * @ingroup group02
+    * @brief Enables or disables the verify-after-write
+    * @details When enabled, each write to IODIR, IPOL, GPINTEN, DEFVAL, INTCON, IOCON or GPPU is read back (one more I2C transaction).
+    * @details A different value is a MCP_BUS_VERIFY_ERROR and the write is repeated according to the retry policy (see setRetryPolicy).
+    * @details OLAT / GPIO writes are not verified. A burst is read back up to GPPU only (INTCAP and GPIO are never read: it would clear the interrupt).
+    * @details Bursts written with the Sequential Operation disabled or with IOCON in the middle are not verified.
+    * @param enabled true = read back the configuration registers
+    */
+   inline void setVerifyWrites(bool enabled) { this->verifyWrites = enabled; };
+
+   /**
+    * @ingroup group02
+    * @brief Returns the bus error statistics of the device
+    * @see mcp23008_bus_errors
+    */
+   inline mcp23008_bus_errors getBusErrors() { return this->busErrors; };
+
+   /**
+    * @ingroup group02
+    * @brief Clears the bus error statistics
+    */
+   inline void clearBusErrors()
+   {
+      memset(&this->busErrors, 0, sizeof(this->busErrors));
+   };
+
+   /**
+    * @ingroup group02
+    * @brief Returns the last bus status different from MCP_BUS_OK (MCP_BUS_OK if no error since the last clearBusErrors)
+    */
+   inline uint8_t getLastError() { return this->busErrors.lastError; };
+
+   /**
+    * @ingroup group01
+    * @brief Selects the transport (bus) used to talk to the device
+    * @details Call it before setup. The default transport is the Arduino Wire (MCPWireBus). 
+    * @details On non Arduino builds there is no default transport and this method must be called.
+    * @code
+    *   MCPSimDevice chip;
+    *   MCPSimulatedBus simBus;
+    *   simBus.attach(0x20, &chip);
+    *   mcp.setBus(&simBus);
+    *   mcp.setup(0x20);
+    * @endcode
+    * @param bus the transport 
+    */
+   inline void setBus(MCPBus *bus) { this->bus = bus; };
+
+   /**
+    * @ingroup group01
+    * @brief Returns the current transport (bus)
+    * @return MCPBus* 
+    */
+   inline MCPBus *getBus() { return this->bus; };
+
+   /**
+    * @ingroup group01
+    * @brief Returns the device address
+    * @return uint8_t 
+    */
+   inline uint8_t getAddress() { return this->i2cAddress; };
 
    /**
    * @ingroup group02
    * @brief Returns the current MCP GPIO pin levels 
-   * 
+   * @details In GPIO stream mode (see beginGpioStream), the register address is not sent again.
    * @return uint8_t 
    */
    inline uint8_t getGPIOS()
    {
-      this->gpios = getRegister(REG_GPIO);
+      if (this->gpioStream)
+         this->readGpioSamples(&this->gpios, 1);
+      else 
+         this->gpios = getRegister(REG_GPIO);
       return this->gpios;
    };
 
@@ -148,6 +483,8 @@ public:
       return this->intf;
    };
 
+   bool getInterruptCapture(uint8_t *intf, uint8_t *intcap);
+
    /**
     * @ingroup group01
     * @brief Checks if the Bit Value of a given bit position is high
@@ -168,9 +505,11 @@ public:
      */
    inline void setClock(long freq)
    {
-      Wire.setClock(freq);
+      this->bus->setClock(freq);
    };
 
 };
 
+#endif // _PU2CLR_MCP23008_H
+
 
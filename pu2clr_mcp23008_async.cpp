@@ -0,0 +1,298 @@
+/**
+ * @file pu2clr_mcp23008_async.cpp
+ * @brief Asynchronous (non-blocking) request engine for the MCP23008 - implementation
+ */
+
+#include "pu2clr_mcp23008_async.h"
+
+/** @defgroup group07 MCP23008 asynchronous requests */
+
+/**
+ * @ingroup group07
+ * @brief Producer - takes a free request of the queue
+ * @details The request becomes visible to poll only after it is filled (see the submit methods).
+ * @return mcp23008_request* (0 if the queue is full)
+ */
+mcp23008_request *MCPAsync::submit(uint8_t type, MCPAsyncCallback callback, volatile uint8_t *status, void *context) {
+    uint8_t head = this->head;
+    mcp23008_request *request;
+
+    if (((head + 1) & (MCP_ASYNC_QUEUE_SIZE - 1)) == this->tail)
+        return 0;
+    request = &this->ring[head];
+    memset(request, 0, sizeof(mcp23008_request));
+    request->type = type;
+    request->callback = callback;
+    request->status = status;
+    request->context = context;
+    if (status)
+        *status = MCP_ASYNC_PENDING;
+    return request;
+}
+
+/**
+ * @ingroup group07
+ * @brief Queues a read of a block of consecutive registers (single sequential read; see MCP::readRegisters)
+ * @param reg first register
+ * @param buf receives the values (must be valid until the request completes)
+ * @param n number of registers
+ * @param callback called when the request completes (optional)
+ * @param status receives MCP_ASYNC_PENDING now and the bus status when the request completes (optional)
+ * @param context user data (request->context)
+ * @return false if the queue is full
+ */
+bool MCPAsync::readRegisters(uint8_t reg, uint8_t *buf, uint8_t n, MCPAsyncCallback callback, volatile uint8_t *status, void *context) {
+    mcp23008_request *request = this->submit(MCP_ASYNC_READ, callback, status, context);
+    if (!request)
+        return false;
+    request->reg = reg;
+    request->buf = buf;
+    request->n = n;
+    MCP_MEMORY_BARRIER(); // the request must be visible before the new head
+    this->head = (this->head + 1) & (MCP_ASYNC_QUEUE_SIZE - 1);
+    return true;
+}
+
+/**
+ * @ingroup group07
+ * @brief Queues a write of a block of consecutive registers (single sequential write; see MCP::writeRegisters)
+ * @param reg first register
+ * @param buf values (must be valid until the request completes)
+ * @param n number of registers
+ * @see readRegisters
+ * @return false if the queue is full
+ */
+bool MCPAsync::writeRegisters(uint8_t reg, const uint8_t *buf, uint8_t n, MCPAsyncCallback callback, volatile uint8_t *status, void *context) {
+    mcp23008_request *request = this->submit(MCP_ASYNC_WRITE, callback, status, context);
+    if (!request)
+        return false;
+    request->reg = reg;
+    request->buf = (uint8_t *)buf;
+    request->n = n;
+    MCP_MEMORY_BARRIER();
+    this->head = (this->head + 1) & (MCP_ASYNC_QUEUE_SIZE - 1);
+    return true;
+}
+
+/**
+ * @ingroup group07
+ * @brief Queues a read of a given register
+ * @details The value is delivered in request->value (callback).
+ * @param reg register
+ * @param callback receives the value
+ * @see readRegisters
+ * @return false if the queue is full
+ */
+bool MCPAsync::getRegister(uint8_t reg, MCPAsyncCallback callback, volatile uint8_t *status, void *context) {
+    mcp23008_request *request = this->submit(MCP_ASYNC_READ, callback, status, context);
+    if (!request)
+        return false;
+    request->reg = reg;
+    request->buf = &request->value;
+    request->n = 1;
+    MCP_MEMORY_BARRIER();
+    this->head = (this->head + 1) & (MCP_ASYNC_QUEUE_SIZE - 1);
+    return true;
+}
+
+/**
+ * @ingroup group07
+ * @brief Queues a write of a given register (the value is kept in the request)
+ * @param reg register
+ * @param value value
+ * @see readRegisters
+ * @return false if the queue is full
+ */
+bool MCPAsync::setRegister(uint8_t reg, uint8_t value, MCPAsyncCallback callback, volatile uint8_t *status, void *context) {
+    mcp23008_request *request = this->submit(MCP_ASYNC_WRITE, callback, status, context);
+    if (!request)
+        return false;
+    request->reg = reg;
+    request->value = value;
+    request->buf = &request->value;
+    request->n = 1;
+    MCP_MEMORY_BARRIER();
+    this->head = (this->head + 1) & (MCP_ASYNC_QUEUE_SIZE - 1);
+    return true;
+}
+
+/**
+ * @ingroup group07
+ * @brief Queues a delay
+ * @details The next requests start after the given time. poll does not wait; it just returns until the time elapses.
+ * @param us delay in microseconds
+ * @see readRegisters
+ * @return false if the queue is full
+ */
+bool MCPAsync::wait(uint32_t us, MCPAsyncCallback callback, volatile uint8_t *status, void *context) {
+    mcp23008_request *request = this->submit(MCP_ASYNC_DELAY, callback, status, context);
+    if (!request)
+        return false;
+    request->time = us;
+    MCP_MEMORY_BARRIER();
+    this->head = (this->head + 1) & (MCP_ASYNC_QUEUE_SIZE - 1);
+    return true;
+}
+
+/**
+ * @ingroup group07
+ * @brief Queues a change of a MCU digital pin (pinMode OUTPUT + digitalWrite)
+ * @param pin MCU pin
+ * @param value HIGH or LOW
+ * @see readRegisters
+ * @return false if the queue is full
+ */
+bool MCPAsync::pinWrite(int pin, uint8_t value, MCPAsyncCallback callback, volatile uint8_t *status, void *context) {
+    mcp23008_request *request = this->submit(MCP_ASYNC_PIN, callback, status, context);
+    if (!request)
+        return false;
+    request->pin = pin;
+    request->value = value;
+    MCP_MEMORY_BARRIER();
+    this->head = (this->head + 1) & (MCP_ASYNC_QUEUE_SIZE - 1);
+    return true;
+}
+
+/**
+ * @ingroup group07
+ * @brief Queues the reset sequence (non-blocking version of MCP::reset)
+ * @details The RESET pin goes high, low and high again; each step lasts MCP_RESET_PULSE_US.
+ * @details After that, the MCP shadow registers are set to the Power-on Reset values and the request completes.
+ * @details It uses a single request of the queue.
+ * @param pin MCU pin connected to the MCP23008 RESET
+ * @see readRegisters, MCP::reset
+ * @return false if the queue is full
+ */
+bool MCPAsync::reset(int pin, MCPAsyncCallback callback, volatile uint8_t *status, void *context) {
+    mcp23008_request *request = this->submit(MCP_ASYNC_RESET, callback, status, context);
+    if (!request)
+        return false;
+    request->pin = pin;
+    MCP_MEMORY_BARRIER();
+    this->head = (this->head + 1) & (MCP_ASYNC_QUEUE_SIZE - 1);
+    return true;
+}
+
+/**
+ * @ingroup group07
+ * @brief Checks if the time of the last executed step elapsed and the bus is free
+ */
+bool MCPAsync::isReady() {
+    return !this->mcp->getBus()->isBusy() && (uint32_t)(micros() - this->since) >= this->waitTime;
+}
+
+/**
+ * @ingroup group07
+ * @brief Returns the status of a failed transfer (the last bus error of the device; MCP_BUS_ERROR if the bus did not report one)
+ */
+uint8_t MCPAsync::failure() {
+    uint8_t status = this->mcp->getLastError();
+    return (status != MCP_BUS_OK) ? status : MCP_BUS_ERROR;
+}
+
+/**
+ * @ingroup group07
+ * @brief Executes the current step of a request
+ * @param request the current request
+ */
+void MCPAsync::execute(mcp23008_request *request) {
+    this->waitTime = 0;
+    switch (request->type)
+    {
+    case MCP_ASYNC_READ:
+        if (request->n == 1)  // one transaction (no IOCON access)
+            request->result = this->mcp->readRegister(request->reg, request->buf);
+        else
+            request->result = (this->mcp->readRegisters(request->reg, request->buf, request->n) == request->n) ? MCP_BUS_OK : this->failure();
+        request->phase = MCP_ASYNC_FINISHED;
+        break;
+    case MCP_ASYNC_WRITE:
+        if (request->n == 1)
+            request->result = this->mcp->writeRegister(request->reg, request->buf[0]);
+        else
+            request->result = (this->mcp->writeRegisters(request->reg, request->buf, request->n) == request->n) ? MCP_BUS_OK : this->failure();
+        request->phase = MCP_ASYNC_FINISHED;
+        break;
+    case MCP_ASYNC_DELAY:
+        this->waitTime = request->time;
+        request->phase = MCP_ASYNC_FINISHED;
+        break;
+    case MCP_ASYNC_PIN:
+        pinMode(request->pin, OUTPUT);
+        digitalWrite(request->pin, request->value);
+        request->phase = MCP_ASYNC_FINISHED;
+        break;
+    case MCP_ASYNC_RESET:
+        if (request->phase == 0)
+            pinMode(request->pin, OUTPUT);
+        digitalWrite(request->pin, (request->phase == 1) ? LOW : HIGH);
+        this->waitTime = MCP_RESET_PULSE_US;
+        if (++request->phase == 3)
+        {   // the device is in its Power-on Reset state after the last pulse
+            this->mcp->setPowerOnResetValues();
+            request->phase = MCP_ASYNC_FINISHED;
+        }
+        break;
+    default:
+        request->result = MCP_BUS_ERROR;
+        request->phase = MCP_ASYNC_FINISHED;
+    }
+    this->since = micros();
+    this->waiting = true;
+}
+
+/**
+ * @ingroup group07
+ * @brief Consumer - reports the result of the current request and releases it
+ * @details The request is released after the callback. So, the callback can use it and submit new requests.
+ * @param request the current request
+ */
+void MCPAsync::complete(mcp23008_request *request) {
+    if (request->status)
+        *request->status = request->result;
+    if (request->callback)
+        request->callback(request->result, request);
+    MCP_MEMORY_BARRIER();
+    this->tail = (this->tail + 1) & (MCP_ASYNC_QUEUE_SIZE - 1);
+}
+
+/**
+ * @ingroup group07
+ * @brief Advances the queue
+ * @details Executes at most one step (one request or one step of the reset sequence) per call. It never waits for the bus or a deadline:
+ * @details if the time of the last step did not elapse or the transport is busy (MCPBus::isBusy), it just returns.
+ * @details A request completes when its last step was executed, its time elapsed and the transport is free.
+ * @return true if there are requests not completed yet
+ */
+bool MCPAsync::poll() {
+    mcp23008_request *request;
+    uint8_t tail = this->tail;
+
+    if (tail == this->head)
+        return false;
+    MCP_MEMORY_BARRIER(); // reads the request after the head
+    request = &this->ring[tail];
+
+    if (this->waiting)
+    {
+        if (!this->isReady())
+            return true;
+        this->waiting = false;
+        if (request->phase == MCP_ASYNC_FINISHED)
+        {
+            this->complete(request);
+            return !this->isIdle();
+        }
+    }
+    else if (this->mcp->getBus()->isBusy())
+        return true;
+
+    this->execute(request);
+    if (this->isReady())
+    {   // blocking transport and no delay: completes in the same call
+        this->waiting = false;
+        if (request->phase == MCP_ASYNC_FINISHED)
+            this->complete(request);
+    }
+    return !this->isIdle();
+}
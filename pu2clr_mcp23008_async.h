@@ -0,0 +1,139 @@
+/**
+ * @file pu2clr_mcp23008_async.h
+ * @brief Asynchronous (non-blocking) request engine for the MCP23008
+ * @details The MCP functions block the CPU during the whole I2C transaction and the reset blocks it for 15ms (delay).
+ * @details MCPAsync queues the requests (register reads and writes, delays, MCU pin changes and the reset sequence) and
+ * @details poll() advances them one step per call: at most one request is executed per call and the time based steps (delays and the 
+ * @details reset pulses) are micros() deadlines. So, no delay() is spent inside the library. If the transport is busy (MCPBus::isBusy), poll() just returns.
+ * @details The transfer itself is still a blocking MCP call: MCPBus has no split-transaction (start / complete) interface. So poll() returns after
+ * @details one blocking transaction (plus the IOCON steps below), and isBusy is only meaningful with a background transport (or a simulated latency).
+ * @details A single register request (getRegister, setRegister) is one I2C transaction, or none if it is served by the register cache / staged in a batch.
+ * @details A block request (readRegisters, writeRegisters) is one sequential transfer. If the IOCON SEQOP state is not known yet or SEQOP = 1,
+ * @details the IOCON read / changes around it (see MCP::readRegisters) are done in the same poll call (up to three more transactions).
+ * @details With a retry policy (MCP::setRetryPolicy), a failed transfer is repeated in the same poll call, after the backoff time (delayMicroseconds).
+ * @details Keep the retries off (default) where poll must not wait.
+ * @details A request completes via a callback and/or a status flag (MCP_ASYNC_PENDING until it completes; then the bus status).
+ * @details The requests go through the MCP object. So, the register cache, the write elision and the batch keep working.
+ * @details Call poll() in the loop (or in a timer context where the bus can be used). The requests can be submitted from the loop and
+ * @details from the callbacks (single producer / single consumer ring buffer).
+ * @code
+ *   MCP mcp;
+ *   MCPAsync async(&mcp);
+ *   volatile uint8_t resetDone;
+ *
+ *   void onInputs(uint8_t status, const mcp23008_request *request) { if (status == MCP_BUS_OK) use(request->value); }
+ *
+ *   void setup() {
+ *     mcp.setup(0x20, 0B00001111);
+ *     async.reset(8, 0, &resetDone);            // pin 8 drives the MCP23008 RESET; no blocking delay
+ *     async.setRegister(REG_IODIR, 0B00001111);  // queued after the reset
+ *   }
+ *   void loop() {
+ *     async.poll();
+ *     if (async.isIdle()) async.getRegister(REG_GPIO, onInputs);
+ *     serviceUart();                             // not delayed by the I2C traffic
+ *   }
+ * @endcode
+ */
+
+#ifndef _PU2CLR_MCP23008_ASYNC_H
+#define _PU2CLR_MCP23008_ASYNC_H
+
+#include "pu2clr_mcp23008.h"
+
+#ifndef MCP_ASYNC_QUEUE_SIZE
+#define MCP_ASYNC_QUEUE_SIZE 8 //!< Number of requests of the queue (power of 2; up to 128)
+#endif
+
+#if (MCP_ASYNC_QUEUE_SIZE < 2) || (MCP_ASYNC_QUEUE_SIZE > 128) || (MCP_ASYNC_QUEUE_SIZE & (MCP_ASYNC_QUEUE_SIZE - 1))
+#error "MCP_ASYNC_QUEUE_SIZE must be a power of 2 between 2 and 128 (the ring indexes are masked)"
+#endif
+
+#ifndef MCP_RESET_PULSE_US
+#define MCP_RESET_PULSE_US 5000 //!< Length of each step of the reset sequence (the same 5ms used by MCP::reset)
+#endif
+
+#define MCP_ASYNC_PENDING 0xFF //!< Status flag value while the request is not complete
+
+// Request types
+#define MCP_ASYNC_READ 0   //!< Reads a block of registers
+#define MCP_ASYNC_WRITE 1  //!< Writes a block of registers
+#define MCP_ASYNC_DELAY 2  //!< Waits (no bus traffic)
+#define MCP_ASYNC_PIN 3    //!< Sets a MCU digital pin
+#define MCP_ASYNC_RESET 4  //!< Reset sequence (RESET pin high, low, high; 5ms each)
+
+#define MCP_ASYNC_FINISHED 0xFF //!< phase value of a request whose last step was executed
+
+struct mcp23008_request;
+
+/**
+ * @brief Completion callback
+ * @param status bus status (MCP_BUS_OK on success)
+ * @param request the completed request (valid during the call only). For getRegister, the value is request->value
+ */
+typedef void (*MCPAsyncCallback)(uint8_t status, const struct mcp23008_request *request);
+
+/**
+ * @brief Asynchronous request
+ */
+typedef struct mcp23008_request
+{
+   uint8_t type;               //!< MCP_ASYNC_READ, MCP_ASYNC_WRITE, MCP_ASYNC_DELAY, MCP_ASYNC_PIN or MCP_ASYNC_RESET
+   uint8_t phase;              //!< current step (MCP_ASYNC_FINISHED after the last one)
+   uint8_t reg;                //!< first register
+   uint8_t n;                  //!< number of registers
+   uint8_t value;              //!< single register value (getRegister / setRegister) or pin level
+   uint8_t result;             //!< bus status
+   int pin;                    //!< MCU pin (MCP_ASYNC_PIN and MCP_ASYNC_RESET)
+   uint8_t *buf;               //!< registers (owned by the caller; must be valid until the request completes)
+   uint32_t time;              //!< delay (us)
+   MCPAsyncCallback callback;  //!< called when the request completes (optional)
+   volatile uint8_t *status;   //!< receives the bus status when the request completes (optional)
+   void *context;              //!< user data
+} mcp23008_request;
+
+/**
+ * @brief Asynchronous request engine
+ */
+class MCPAsync
+{
+protected:
+   MCP *mcp;
+   mcp23008_request ring[MCP_ASYNC_QUEUE_SIZE];
+   volatile uint8_t head = 0;  //!< next free request (changed by the submit methods only)
+   volatile uint8_t tail = 0;  //!< current request (changed by poll only)
+   bool waiting = false;       //!< a step of the current request was executed and its time / the bus is not released yet
+   uint32_t since = 0;         //!< micros() at the last executed step
+   uint32_t waitTime = 0;      //!< us to wait after the last executed step
+
+   mcp23008_request *submit(uint8_t type, MCPAsyncCallback callback, volatile uint8_t *status, void *context);
+   void execute(mcp23008_request *request);
+   uint8_t failure();
+   void complete(mcp23008_request *request);
+   bool isReady();
+
+public:
+   MCPAsync(MCP *mcp) : mcp(mcp) {};
+   bool readRegisters(uint8_t reg, uint8_t *buf, uint8_t n, MCPAsyncCallback callback = 0, volatile uint8_t *status = 0, void *context = 0);
+   bool writeRegisters(uint8_t reg, const uint8_t *buf, uint8_t n, MCPAsyncCallback callback = 0, volatile uint8_t *status = 0, void *context = 0);
+   bool getRegister(uint8_t reg, MCPAsyncCallback callback, volatile uint8_t *status = 0, void *context = 0);
+   bool setRegister(uint8_t reg, uint8_t value, MCPAsyncCallback callback = 0, volatile uint8_t *status = 0, void *context = 0);
+   bool wait(uint32_t us, MCPAsyncCallback callback = 0, volatile uint8_t *status = 0, void *context = 0);
+   bool pinWrite(int pin, uint8_t value, MCPAsyncCallback callback = 0, volatile uint8_t *status = 0, void *context = 0);
+   bool reset(int pin, MCPAsyncCallback callback = 0, volatile uint8_t *status = 0, void *context = 0);
+   bool poll();
+
+   /**
+    * @ingroup group07
+    * @brief Returns the number of requests not completed yet
+    */
+   inline uint8_t pending() { return (uint8_t)(this->head - this->tail) & (MCP_ASYNC_QUEUE_SIZE - 1); };
+
+   /**
+    * @ingroup group07
+    * @brief Checks if all requests were completed
+    */
+   inline bool isIdle() { return this->head == this->tail; };
+};
+
+#endif // _PU2CLR_MCP23008_ASYNC_H
@@ -0,0 +1,131 @@
+/**
+ * @file pu2clr_mcp23008_bank.cpp
+ * @brief Up to 8 MCP23008 devices handled as one 64 bit port - implementation
+ */
+
+#include "pu2clr_mcp23008_bank.h"
+
+/** @defgroup group03 MCP23008 bank (up to 64 pins) */
+
+/**
+ * @ingroup group03
+ * @brief Starts the devices
+ * @details The devices must use consecutive addresses starting at firstAddress. The bus is started only once.
+ * @param count number of devices (1 ~ 8)
+ * @param io IODIR value for all devices (GPIO_OUTPUT, GPIO_INPUT or a bitmask). See setDirection to set each device.
+ * @param firstAddress address of the first device (default 0x20)
+ * @param bus transport shared by all devices (default Arduino Wire)
+ * @param i2c_freq I2C bus frequency/speed (default 100000 = 100KHz)
+ */
+void MCPBank::setup(uint8_t count, uint8_t io, uint8_t firstAddress, MCPBus *bus, long i2c_freq) {
+    if (count > MCP_BANK_MAX_DEVICES)
+        count = MCP_BANK_MAX_DEVICES;
+    this->count = count;
+    for (uint8_t i = 0; i < count; i++)
+    {
+        this->devices[i].setBus(bus);
+        this->devices[i].setRegisterCache(true); // seeded by setup
+        this->devices[i].setup(firstAddress + i, io, -1, i2c_freq);
+    }
+}
+
+/**
+ * @ingroup group03
+ * @brief Sets the direction of all pins
+ * @details Only the devices whose IODIR changed are written.
+ * @param iodir 64 bit mask (1 = input; 0 = output)
+ */
+void MCPBank::setDirection(uint64_t iodir) {
+    uint8_t value;
+    for (uint8_t i = 0; i < this->count; i++)
+    {
+        value = (uint8_t)(iodir >> (8 * i));
+        if (this->devices[i].getRegister(REG_IODIR) != value) // served from the register cache
+            this->devices[i].setRegister(REG_IODIR, value);
+    }
+}
+
+/**
+ * @ingroup group03
+ * @brief Reads the GPIO register of all devices
+ * @details One I2C transaction per device.
+ * @return uint64_t pin levels (bit 0 = pin 0 of the first device)
+ */
+uint64_t MCPBank::readAll() {
+    uint64_t value = 0;
+    for (uint8_t i = 0; i < this->count; i++)
+        value |= (uint64_t)this->devices[i].getGPIOS() << (8 * i);
+    return value;
+}
+
+/**
+ * @ingroup group03
+ * @brief Returns the output latches of all devices
+ * @details No I2C traffic. The values come from the OLAT shadow registers.
+ * @return uint64_t
+ */
+uint64_t MCPBank::getOutputs() {
+    uint64_t value = 0;
+    for (uint8_t i = 0; i < this->count; i++)
+        value |= (uint64_t)this->devices[i].getRegister(REG_OLAT) << (8 * i);
+    return value;
+}
+
+/**
+ * @ingroup group03
+ * @brief Writes the output latches of all devices
+ * @details Only the devices whose OLAT changed are written.
+ * @param value 64 bit value (bit 0 = pin 0 of the first device)
+ */
+void MCPBank::writeAll(uint64_t value) {
+    this->writeMasked(value, ~(uint64_t)0);
+}
+
+/**
+ * @ingroup group03
+ * @brief Writes only the bits selected by mask
+ * @details Devices with no selected bit, or whose masked bits did not change, are skipped. 
+ * @details The other devices are written in a single I2C transaction each.
+ * @param value 64 bit value
+ * @param mask  64 bit mask (1 = the bit of value is written)
+ */
+void MCPBank::writeMasked(uint64_t value, uint64_t mask) {
+    uint8_t m, olat, aux;
+    for (uint8_t i = 0; i < this->count; i++)
+    {
+        m = (uint8_t)(mask >> (8 * i));
+        if (m == 0)
+            continue;
+        olat = this->devices[i].getRegister(REG_OLAT); // served from the register cache
+        aux = (olat & ~m) | ((uint8_t)(value >> (8 * i)) & m);
+        if (aux != olat)
+            this->devices[i].setRegister(REG_OLAT, aux);
+    }
+}
+
+/**
+ * @ingroup group03
+ * @brief Reads a given pin 
+ * @param pin 0 ~ 63
+ * @return true if the pin is high
+ */
+bool MCPBank::pinRead(uint8_t pin) {
+    if ((pin >> 3) >= this->count)
+        return false;
+    return this->devices[pin >> 3].gpioRead(pin & 7);
+}
+
+/**
+ * @ingroup group03
+ * @brief Writes a given pin 
+ * @details Nothing is sent if the pin is already at the given level.
+ * @param pin 0 ~ 63
+ * @param value HIGH or LOW
+ */
+void MCPBank::pinWrite(uint8_t pin, uint8_t value) {
+    uint64_t mask;
+    if (pin >= 64)
+        return;
+    mask = (uint64_t)1 << pin;
+    this->writeMasked((value) ? mask : 0, mask);
+}
@@ -0,0 +1,58 @@
+/**
+ * @file pu2clr_mcp23008_bank.h
+ * @brief Up to 8 MCP23008 devices (addresses 0x20 ~ 0x27) handled as one 64 bit port
+ * @details The pins are numbered from 0 to 63. Pin 0 ~ 7 belong to the first device, pin 8 ~ 15 to the second one and so on.
+ * @details All devices share the same transport (bus). The register cache of each device is enabled. 
+ * @details So, writes are computed from the OLAT shadow registers and only the devices whose bits changed are written (one transaction per device).
+ * @code
+ *   MCPBank bank;
+ *   bank.setup(6);                                  // 6 devices at 0x20 ~ 0x25 - 48 outputs
+ *   bank.writeMasked(0x0000FF0000FFULL, 0x0000FF0000FFULL); // only the devices 0 and 3 are written
+ *   bank.pinWrite(42, HIGH);
+ * @endcode
+ */
+
+#ifndef _PU2CLR_MCP23008_BANK_H
+#define _PU2CLR_MCP23008_BANK_H
+
+#include "pu2clr_mcp23008.h"
+
+#define MCP_BANK_MAX_DEVICES 8 //!< Maximum number of MCP23008 devices on the same I2C bus
+
+/**
+ * @brief Up to 8 MCP23008 devices handled as one 64 bit port
+ */
+class MCPBank
+{
+protected:
+   MCP devices[MCP_BANK_MAX_DEVICES];
+   uint8_t count = 0; //!< number of devices
+
+public:
+   void setup(uint8_t count, uint8_t io = GPIO_OUTPUT, uint8_t firstAddress = 0x20, MCPBus *bus = MCP::defaultBus(), long i2c_freq = 100000);
+   void setDirection(uint64_t iodir);
+   uint64_t readAll();
+   void writeAll(uint64_t value);
+   void writeMasked(uint64_t value, uint64_t mask);
+   uint64_t getOutputs();
+   bool pinRead(uint8_t pin);
+   void pinWrite(uint8_t pin, uint8_t value);
+
+   /**
+    * @ingroup group03
+    * @brief Returns the number of devices
+    * @return uint8_t
+    */
+   inline uint8_t getCount() { return this->count; };
+
+   /**
+    * @ingroup group03
+    * @brief Returns a given device 
+    * @details Use it to access the device specific features (interrupts, pull-up etc). 
+    * @param index 0 ~ getCount() - 1
+    * @return MCP* (0 if the index is out of range)
+    */
+   inline MCP *getDevice(uint8_t index) { return (index < this->count) ? &this->devices[index] : 0; };
+};
+
+#endif // _PU2CLR_MCP23008_BANK_H
@@ -0,0 +1,106 @@
+/**
+ * @file pu2clr_mcp23008_config.cpp
+ * @brief MCP23008 configuration snapshot - implementation
+ */
+
+#include "pu2clr_mcp23008_config.h"
+
+/** @defgroup group14 MCP23008 configuration snapshot */
+
+/**
+ * @ingroup group14
+ * @brief Builds a configuration (profile)
+ */
+MCPConfig::MCPConfig(uint8_t iodir, uint8_t ipol, uint8_t gpinten, uint8_t defval, uint8_t intcon, uint8_t iocon, uint8_t gppu, uint8_t olat) {
+    this->regs[REG_IODIR] = iodir;
+    this->regs[REG_IPOL] = ipol;
+    this->regs[REG_GPINTEN] = gpinten;
+    this->regs[REG_DEFVAL] = defval;
+    this->regs[REG_INTCON] = intcon;
+    this->regs[REG_IOCON] = iocon;
+    this->regs[REG_GPPU] = gppu;
+    this->regs[REG_OLAT] = olat;
+}
+
+/**
+ * @ingroup group14
+ * @brief Takes the configuration of a device
+ * @details With the register cache enabled, the values come from the shadow registers (no I2C traffic).
+ * @details Otherwise, IODIR ~ GPPU are read in a single sequential read and OLAT in another one.
+ * @details INTCAP and GPIO are not read, so a pending interrupt is not cleared.
+ * @param mcp the device
+ * @return true if the registers were read
+ */
+bool MCPConfig::capture(MCP *mcp) {
+    uint8_t buf[REG_GPPU + 1];
+
+    if (mcp->isRegisterCacheEnabled())
+    {
+        for (uint8_t reg = REG_IODIR; reg <= REG_OLAT; reg++)
+            if (CHECK_BIT_HIGH(MCP_WRITABLE_REGS, reg))
+                this->regs[reg] = mcp->getRegister(reg);
+        return true;
+    }
+
+    if (mcp->readRegisters(REG_IODIR, buf, REG_GPPU + 1) != REG_GPPU + 1 || mcp->readRegisters(REG_OLAT, &this->regs[REG_OLAT], 1) != 1)
+        return false;
+    memcpy(this->regs, buf, sizeof(buf));
+    return true;
+}
+
+/**
+ * @ingroup group14
+ * @brief Compares two configurations
+ * @param other the other configuration
+ * @return uint16_t registers with different values (bit n = register n)
+ */
+uint16_t MCPConfig::diff(const MCPConfig &other) const {
+    uint16_t mask = 0;
+    for (uint8_t reg = REG_IODIR; reg <= REG_OLAT; reg++)
+        if (CHECK_BIT_HIGH(MCP_WRITABLE_REGS, reg) && this->regs[reg] != other.regs[reg])
+            mask |= 1 << reg;
+    return mask;
+}
+
+/**
+ * @ingroup group14
+ * @brief Writes the configuration to a device (only the registers that are different)
+ * @details The register cache of the device is used as the current configuration. If it is disabled, it is loaded 
+ * @details for the call (two sequential reads, INTCAP and GPIO are not read) and disabled again at the end.
+ * @details The changed registers are staged in a batch and written by MCP::commit as sequential bursts (IOCON first).
+ * @details If pins become outputs and OLAT changes, OLAT is written first.
+ * @details If the caller has a batch open (see MCP::isBatching), the changes are only staged and the caller commits them. 
+ * @details In this case the commit writes the registers in ascending order (IODIR before OLAT).
+ * @param mcp the device
+ * @return true if all changed registers were written (or staged)
+ */
+bool MCPConfig::apply(MCP *mcp) const {
+    MCPConfig current;
+    uint16_t changed;
+    bool batching = mcp->isBatching();
+    bool cached = mcp->isRegisterCacheEnabled();
+    bool result = true;
+
+    mcp->setRegisterCache(true);
+    current.capture(mcp);
+    changed = this->diff(current);
+    if (changed != 0)
+    {
+        if (!batching && CHECK_BIT_HIGH(changed, REG_OLAT) && (current.regs[REG_IODIR] & ~this->regs[REG_IODIR]))
+        {   // new outputs: the output latch first
+            mcp->setRegister(REG_OLAT, this->regs[REG_OLAT], true);
+            changed &= ~(1 << REG_OLAT);
+        }
+
+        if (!batching)
+            mcp->beginBatch();
+        for (uint8_t reg = REG_IODIR; reg <= REG_OLAT; reg++)
+            if (CHECK_BIT_HIGH(changed, reg))
+                mcp->setRegister(reg, this->regs[reg], true);
+        if (!batching)
+            result = mcp->commit();
+    }
+    if (!cached)
+        mcp->setRegisterCache(false);   // the caller's cache mode is kept
+    return result;
+}
@@ -0,0 +1,75 @@
+/**
+ * @file pu2clr_mcp23008_config.h
+ * @brief MCP23008 configuration snapshot (IODIR, IPOL, GPINTEN, DEFVAL, INTCON, IOCON, GPPU and OLAT)
+ * @details MCPConfig is a value type (copy it, keep it in a table of profiles etc).
+ * @details capture() takes the configuration of a device, diff() compares two configurations and apply() writes only the registers
+ * @details that are different from the device. apply() uses the MCP batch (see MCP::beginBatch): the changed registers are written as
+ * @details sequential bursts over contiguous ranges. Switching between two profiles usually takes one or two I2C transactions.
+ * @details If pins become outputs and OLAT changes, OLAT is written before IODIR (the new outputs start with the new levels; no glitches).
+ * @code
+ *   MCPConfig inputCapture(0xFF, 0, 0xFF, 0, 0, 0, 0xFF, 0);        // all inputs, pull up and interrupt-on-change
+ *   MCPConfig outputDrive(0x00, 0, 0, 0, 0, 0, 0, 0B10100101);      // all outputs
+ *
+ *   inputCapture.apply(&mcp);
+ *   ...
+ *   outputDrive.apply(&mcp);   // only the changed registers
+ *
+ *   MCPConfig saved;
+ *   saved.capture(&mcp);       // takes the current configuration
+ * @endcode
+ */
+
+#ifndef _PU2CLR_MCP23008_CONFIG_H
+#define _PU2CLR_MCP23008_CONFIG_H
+
+#include "pu2clr_mcp23008.h"
+
+/**
+ * @brief MCP23008 configuration (value type)
+ */
+class MCPConfig
+{
+protected:
+   uint8_t regs[MCP_REG_COUNT] = {0xFF, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}; //!< register values (INTF, INTCAP and GPIO are not used)
+
+public:
+   /**
+    * @ingroup group14
+    * @brief Power-on Reset configuration (IODIR = 0xFF; all other registers = 0)
+    */
+   MCPConfig() {};
+   MCPConfig(uint8_t iodir, uint8_t ipol, uint8_t gpinten, uint8_t defval, uint8_t intcon, uint8_t iocon, uint8_t gppu, uint8_t olat);
+   bool capture(MCP *mcp);
+   bool apply(MCP *mcp) const;
+   uint16_t diff(const MCPConfig &other) const;
+
+   /**
+    * @ingroup group14
+    * @brief Returns the value of a given register
+    * @param reg REG_IODIR ~ REG_GPPU or REG_OLAT
+    */
+   inline uint8_t getRegister(uint8_t reg) const { return (reg <= REG_OLAT) ? this->regs[reg] : 0; };
+
+   /**
+    * @ingroup group14
+    * @brief Sets the value of a given register
+    * @param reg REG_IODIR ~ REG_GPPU or REG_OLAT (REG_GPIO is the same as REG_OLAT)
+    * @param value register value
+    */
+   inline void setRegister(uint8_t reg, uint8_t value)
+   {
+      if (reg == REG_GPIO)
+         reg = REG_OLAT;
+      if (reg <= REG_OLAT && CHECK_BIT_HIGH(MCP_WRITABLE_REGS, reg))
+         this->regs[reg] = value;
+   };
+
+   /**
+    * @ingroup group14
+    * @brief Checks if two configurations are equal
+    */
+   inline bool operator==(const MCPConfig &other) const { return this->diff(other) == 0; };
+   inline bool operator!=(const MCPConfig &other) const { return this->diff(other) != 0; };
+};
+
+#endif // _PU2CLR_MCP23008_CONFIG_H
@@ -0,0 +1,114 @@
+/**
+ * @file pu2clr_mcp23008_debounce.cpp
+ * @brief Debounced input engine for the MCP23008 - implementation
+ */
+
+#include "pu2clr_mcp23008_debounce.h"
+
+/** @defgroup group08 MCP23008 debounced inputs */
+
+/**
+ * @ingroup group08
+ * @brief Configures the pins as debounced inputs
+ * @details The pins become inputs with interrupt-on-change against the previous value (INTCON = 0).
+ * @details All register changes are written in a single batch. The MCP must be started (MCP::setup) and its INT output configured (MCP::setInterrupt).
+ * @param mask pins to monitor (bit mask)
+ * @param activeLow true if a low level means pressed (button to GND)
+ * @param pullUp true enables the internal pull up resistors of the pins
+ */
+void MCPDebouncer::setup(uint8_t mask, bool activeLow, bool pullUp) {
+    this->mask = mask;
+    this->polarity = (activeLow) ? mask : 0;
+
+    this->mcp->beginBatch();
+    for (uint8_t gpio = 0; gpio < 8; gpio++)
+        if (mask & (1 << gpio))
+            this->mcp->interruptGpioOn(gpio);
+    this->mcp->setRegister(REG_INTCON, this->mcp->getRegister(REG_INTCON) & ~mask);
+    if (pullUp)
+        this->mcp->setRegister(REG_GPPU, this->mcp->getRegister(REG_GPPU) | mask);
+    this->mcp->commit();
+
+    this->pending = false;
+    this->state = this->sample = this->toPressed(this->mcp->getGPIOS()); // also clears a pending interrupt
+    this->count = 0;
+    this->longReported = this->state;  // pins already pressed do not report a long-press
+}
+
+/**
+ * @ingroup group08
+ * @brief Sets the debounce timing
+ * @param interval ms between the GPIO samples (default MCP_DEBOUNCE_INTERVAL)
+ * @param samples consecutive equal samples needed to accept a new state (default MCP_DEBOUNCE_SAMPLES)
+ * @param longPress ms to report a long-press (default MCP_LONG_PRESS; 0 = disabled)
+ */
+void MCPDebouncer::setTiming(uint16_t interval, uint8_t samples, uint16_t longPress) {
+    this->interval = interval;
+    this->samples = (samples) ? samples : 1;
+    this->longPress = longPress;
+}
+
+/**
+ * @ingroup group08
+ * @brief Accepts the stable sample as the new state and computes the press / release events
+ * @param now millis()
+ */
+void MCPDebouncer::accept(uint32_t now) {
+    uint8_t changed = this->sample ^ this->state;
+
+    this->pressed = changed & this->sample;
+    this->released = changed & this->state;
+    this->longReported &= this->sample;  // released pins can report a long-press again
+    this->state = this->sample;
+    this->count = 0;
+
+    if (this->pressed)
+        for (uint8_t gpio = 0; gpio < 8; gpio++)
+            if (this->pressed & (1 << gpio))
+                this->pressTime[gpio] = now;
+}
+
+/**
+ * @ingroup group08
+ * @brief Runs the debouncer. Call it in the loop.
+ * @details Idle (no I2C traffic) until onInterrupt is called. Then, it reads INTCAP and samples GPIO every interval ms (one read per call at most)
+ * @details until the value is stable. The events of the last call are returned by getPressed, getReleased and getLongPressed.
+ * @details If the INT pin is not connected to an interrupt pin, call onInterrupt when it reads as active.
+ * @return true if there is any event
+ */
+bool MCPDebouncer::update() {
+    uint32_t now = millis();
+    uint8_t value, held;
+
+    this->pressed = this->released = this->longPressed = 0;
+
+    if (this->count == 0 && this->pending)
+    {   // start of a settle cycle: INTCAP is the first sample (the read clears the interrupt)
+        this->pending = false;  // cleared before the read; a new change after the read signals again
+        this->sample = this->toPressed(this->mcp->getINTCAP());
+        this->count = 1;
+        this->lastSample = now;
+    }
+    else if (this->count != 0 && (uint32_t)(now - this->lastSample) >= this->interval)
+    {
+        this->pending = false;
+        value = this->toPressed(this->mcp->getGPIOS());
+        this->count = (value == this->sample) ? this->count + 1 : 1;
+        this->sample = value;
+        this->lastSample = now;
+    }
+
+    if (this->count >= this->samples)
+        this->accept(now);
+
+    held = this->state & ~this->longReported;
+    if (this->longPress && held)
+    {   // time event only
+        for (uint8_t gpio = 0; gpio < 8; gpio++)
+            if ((held & (1 << gpio)) && (uint32_t)(now - this->pressTime[gpio]) >= this->longPress)
+                this->longPressed |= 1 << gpio;
+        this->longReported |= this->longPressed;
+    }
+
+    return (this->pressed | this->released | this->longPressed) != 0;
+}
@@ -0,0 +1,115 @@
+/**
+ * @file pu2clr_mcp23008_debounce.h
+ * @brief Debounced input (buttons / switches) engine for the MCP23008
+ * @details The pins are monitored by the MCP23008 interrupt-on-change hardware (GPINTEN, INTCON = 0). While the inputs are quiet there is no I2C traffic.
+ * @details When the INT pin fires, INTCAP is read (first sample) and then GPIO is read every MCP_DEBOUNCE_INTERVAL ms until
+ * @details MCP_DEBOUNCE_SAMPLES consecutive samples are equal. Then, the press / release / long-press events of the 8 pins are computed at once (bit masks).
+ * @details A long-press is a time event only (no I2C traffic).
+ * @code
+ *   MCP mcp;
+ *   MCPDebouncer buttons(&mcp);
+ *
+ *   void isr() { buttons.onInterrupt(); }
+ *
+ *   void setup() {
+ *     mcp.setup(0x20, GPIO_INPUT);
+ *     mcp.setInterrupt(INTERRUPT_INTPOL_ACTIVE_LOW, INTERRUPT_ODR_ACTIVE_DRIVE);
+ *     buttons.setup(0B00001111);     // GPIO 0 ~ 3: active low buttons with the internal pull up
+ *     attachInterrupt(digitalPinToInterrupt(2), isr, FALLING);
+ *   }
+ *   void loop() {
+ *     if (buttons.update()) {
+ *       if (buttons.getPressed() & 0B0001) ...     // GPIO 0 pressed
+ *       if (buttons.getLongPressed() & 0B0010) ... // GPIO 1 held for MCP_LONG_PRESS ms
+ *     }
+ *   }
+ * @endcode
+ */
+
+#ifndef _PU2CLR_MCP23008_DEBOUNCE_H
+#define _PU2CLR_MCP23008_DEBOUNCE_H
+
+#include "pu2clr_mcp23008.h"
+
+#ifndef MCP_DEBOUNCE_INTERVAL
+#define MCP_DEBOUNCE_INTERVAL 5 //!< ms between the GPIO samples after an interrupt
+#endif
+
+#ifndef MCP_DEBOUNCE_SAMPLES
+#define MCP_DEBOUNCE_SAMPLES 3 //!< consecutive equal samples (INTCAP + GPIO reads) needed to accept a new state
+#endif
+
+#ifndef MCP_LONG_PRESS
+#define MCP_LONG_PRESS 1000 //!< ms a pin must stay pressed to report a long-press
+#endif
+
+/**
+ * @brief Debounced input engine (up to 8 pins)
+ */
+class MCPDebouncer
+{
+protected:
+   MCP *mcp;
+   uint8_t mask = 0;            //!< monitored pins
+   uint8_t polarity = 0;        //!< pins whose low level means pressed
+   uint8_t state = 0;           //!< debounced state (1 = pressed)
+   uint8_t sample = 0;          //!< last sample (1 = pressed)
+   uint8_t count = 0;           //!< consecutive equal samples (0 = idle)
+   uint8_t pressed = 0;         //!< pins pressed in the last update
+   uint8_t released = 0;        //!< pins released in the last update
+   uint8_t longPressed = 0;     //!< pins that reached the long-press time in the last update
+   uint8_t longReported = 0;    //!< long-press already reported (until the release)
+   uint32_t lastSample = 0;     //!< millis() at the last sample
+   uint32_t pressTime[8];       //!< millis() when each pin was pressed
+   uint16_t interval = MCP_DEBOUNCE_INTERVAL;
+   uint8_t samples = MCP_DEBOUNCE_SAMPLES;
+   uint16_t longPress = MCP_LONG_PRESS;
+   volatile bool pending = false;
+
+   uint8_t toPressed(uint8_t value) { return (value ^ this->polarity) & this->mask; };
+   void accept(uint32_t now);
+
+public:
+   MCPDebouncer(MCP *mcp) : mcp(mcp) {};
+   void setup(uint8_t mask, bool activeLow = true, bool pullUp = true);
+   void setTiming(uint16_t interval, uint8_t samples, uint16_t longPress);
+   bool update();
+
+   /**
+    * @ingroup group08
+    * @brief Signals an interrupt (ISR safe; no I2C traffic)
+    */
+   inline void onInterrupt() { this->pending = true; };
+
+   /**
+    * @ingroup group08
+    * @brief Checks if a settle cycle is running (GPIO samples being taken)
+    */
+   inline bool isSettling() { return this->count != 0; };
+
+   /**
+    * @ingroup group08
+    * @brief Returns the debounced state of the pins (1 = pressed)
+    */
+   inline uint8_t getState() { return this->state; };
+
+   /**
+    * @ingroup group08
+    * @brief Returns the pins pressed in the last update (bit mask)
+    */
+   inline uint8_t getPressed() { return this->pressed; };
+
+   /**
+    * @ingroup group08
+    * @brief Returns the pins released in the last update (bit mask)
+    */
+   inline uint8_t getReleased() { return this->released; };
+
+   /**
+    * @ingroup group08
+    * @brief Returns the pins that reached the long-press time in the last update (bit mask; reported once per press)
+    */
+   inline uint8_t getLongPressed() { return this->longPressed; };
+};
+
+#endif // _PU2CLR_MCP23008_DEBOUNCE_H
@@ -0,0 +1,105 @@
+/**
+ * @file pu2clr_mcp23008_encoder.cpp
+ * @brief Quadrature encoder decoder - implementation
+ */
+
+#include "pu2clr_mcp23008_encoder.h"
+
+/** @defgroup group09 MCP23008 quadrature encoders */
+
+/**
+ * @brief Quadrature decoding table
+ * @details Index: previous A/B state (bits 3 and 2) and new A/B state (bits 1 and 0). Forward sequence: 00 -> 01 -> 11 -> 10 -> 00.
+ */
+static const int8_t quadratureTable[16] = {
+    0, 1, -1, MCP_ENCODER_INVALID,
+    -1, 0, MCP_ENCODER_INVALID, 1,
+    1, MCP_ENCODER_INVALID, 0, -1,
+    MCP_ENCODER_INVALID, -1, 1, 0};
+
+/**
+ * @ingroup group09
+ * @brief Adds an encoder
+ * @details The pins become inputs with interrupt-on-change against the previous value (INTCON = 0). The register changes are written in a single batch.
+ * @details The register cache of the device is enabled (see MCP::setRegisterCache): the IOCON SEQOP state is then known and service does not read IOCON.
+ * @details The MCP must be started (MCP::setup) and its INT output configured (MCP::setInterrupt).
+ * @param pinA GPIO of the A signal (0 ~ 7)
+ * @param pinB GPIO of the B signal (0 ~ 7)
+ * @param pullUp true enables the internal pull up resistors of the pins
+ * @return int8_t encoder index (-1 if the pins are invalid or there are already MCP_ENCODER_MAX encoders)
+ */
+int8_t MCPEncoder::add(uint8_t pinA, uint8_t pinB, bool pullUp) {
+    mcp23008_encoder *e;
+    uint8_t mask;
+
+    if (this->count >= MCP_ENCODER_MAX || pinA > 7 || pinB > 7 || pinA == pinB)
+        return -1;
+
+    mask = (1 << pinA) | (1 << pinB);
+    this->mcp->setRegisterCache(true);
+    this->mcp->beginBatch();
+    this->mcp->interruptGpioOn(pinA);
+    this->mcp->interruptGpioOn(pinB);
+    this->mcp->setRegister(REG_INTCON, this->mcp->getRegister(REG_INTCON) & ~mask);
+    if (pullUp)
+        this->mcp->setRegister(REG_GPPU, this->mcp->getRegister(REG_GPPU) | mask);
+    this->mcp->commit();
+
+    this->pins |= mask;
+    e = &this->encoders[this->count];
+    e->pinA = pinA;
+    e->pinB = pinB;
+    e->position = 0;
+    e->missed = 0;
+    e->state = this->toState(e, this->mcp->getGPIOS()); // also clears a pending interrupt
+    return this->count++;
+}
+
+/**
+ * @ingroup group09
+ * @brief Decodes a new pin snapshot for all encoders
+ * @param value GPIO / INTCAP value
+ * @return true if a position changed
+ */
+bool MCPEncoder::decode(uint8_t value) {
+    bool changed = false;
+    mcp23008_encoder *e;
+    uint8_t state;
+    int8_t step;
+
+    for (uint8_t i = 0; i < this->count; i++)
+    {
+        e = &this->encoders[i];
+        state = this->toState(e, value);
+        step = quadratureTable[(e->state << 2) | state];
+        if (step == MCP_ENCODER_INVALID)
+            e->missed++;
+        else if (step)
+        {
+            e->position += step;
+            changed = true;
+        }
+        e->state = state;
+    }
+    return changed;
+}
+
+/**
+ * @ingroup group09
+ * @brief Reads INTF, INTCAP and GPIO (single 3 bytes read) and updates all encoders
+ * @details It can also be called without interrupts (polling); each call is one I2C transaction (the register cache is enabled by add;
+ * @details with IOCON SEQOP = 1 the Sequential Operation is enabled around the read - see MCP::readRegisters).
+ * @return true if a position changed
+ */
+bool MCPEncoder::service() {
+    uint8_t r[3]; // INTF, INTCAP and GPIO
+    bool changed;
+
+    if (this->mcp->readRegisters(REG_INTF, r, 3) != 3)
+        return false;
+
+    changed = (r[0]) ? this->decode(r[1]) : false;  // INTCAP is valid only if there was an interrupt
+    if (r[0] && ((r[1] ^ r[2]) & this->pins))
+        this->overruns++;
+    return this->decode(r[2]) || changed;
+}
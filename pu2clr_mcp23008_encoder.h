@@ -0,0 +1,126 @@
+/**
+ * @file pu2clr_mcp23008_encoder.h
+ * @brief Quadrature (rotary) encoder decoder driven by the MCP23008 interrupts
+ * @details Up to MCP_ENCODER_MAX encoders (A/B pin pairs) on one device. The pins are configured with interrupt-on-change against the previous value.
+ * @details On each interrupt, INTF, INTCAP and GPIO are read in a single 3 bytes sequential read (0x07 ~ 0x09; the read clears the interrupt).
+ * @details Two transitions are decoded for every encoder from these bytes: previous state -> INTCAP (value at the interrupt) and INTCAP -> GPIO (value now).
+ * @details Each transition is decoded by a 16 entry table (previous A/B state, new A/B state): +1, -1, no change or invalid (both pins changed).
+ * @details An invalid transition means that at least one step was lost (missed step). A GPIO value different from INTCAP means that the pins changed again
+ * @details before the read (overrun). Both counters show when the bus rate cannot keep up with the rotation speed.
+ * @code
+ *   MCP mcp;
+ *   MCPEncoder encoders(&mcp);
+ *
+ *   void isr() { encoders.onInterrupt(); }
+ *
+ *   void setup() {
+ *     mcp.setup(0x20, GPIO_INPUT);
+ *     mcp.setInterrupt(INTERRUPT_INTPOL_ACTIVE_LOW, INTERRUPT_ODR_ACTIVE_DRIVE);
+ *     encoders.add(MCP_GPIO0, MCP_GPIO1);   // encoder 0
+ *     encoders.add(MCP_GPIO2, MCP_GPIO3);   // encoder 1
+ *     attachInterrupt(digitalPinToInterrupt(2), isr, FALLING);
+ *   }
+ *   void loop() {
+ *     if (encoders.poll())
+ *       show(encoders.getPosition(0), encoders.getPosition(1));
+ *   }
+ * @endcode
+ */
+
+#ifndef _PU2CLR_MCP23008_ENCODER_H
+#define _PU2CLR_MCP23008_ENCODER_H
+
+#include "pu2clr_mcp23008.h"
+
+#define MCP_ENCODER_MAX 4     //!< Maximum number of encoders per device (8 pins)
+#define MCP_ENCODER_INVALID 2 //!< Decoding table value of an invalid transition (both pins changed)
+
+/**
+ * @brief Encoder state
+ */
+typedef struct
+{
+   uint8_t pinA;      //!< GPIO of the A signal
+   uint8_t pinB;      //!< GPIO of the B signal
+   uint8_t state;     //!< last A/B state (A = bit 1; B = bit 0)
+   int32_t position;  //!< counts (4 counts per full quadrature cycle)
+   uint16_t missed;   //!< invalid transitions (lost steps)
+} mcp23008_encoder;
+
+/**
+ * @brief Quadrature encoder decoder (up to 4 encoders per device)
+ */
+class MCPEncoder
+{
+protected:
+   MCP *mcp;
+   mcp23008_encoder encoders[MCP_ENCODER_MAX];
+   uint8_t count = 0;
+   uint8_t pins = 0;        //!< encoder pins (bit mask)
+   uint16_t overruns = 0;   //!< reads where GPIO was different from INTCAP on the encoder pins
+   volatile bool pending = false;
+
+   inline uint8_t toState(const mcp23008_encoder *e, uint8_t value) { return (((value >> e->pinA) & 1) << 1) | ((value >> e->pinB) & 1); };
+   bool decode(uint8_t value);
+
+public:
+   MCPEncoder(MCP *mcp) : mcp(mcp) {};
+   int8_t add(uint8_t pinA, uint8_t pinB, bool pullUp = true);
+   bool service();
+
+   /**
+    * @ingroup group09
+    * @brief Signals an interrupt (ISR safe; no I2C traffic)
+    */
+   inline void onInterrupt() { this->pending = true; };
+
+   /**
+    * @ingroup group09
+    * @brief Services the signaled interrupt (see onInterrupt). Call it in the loop.
+    * @return true if a position changed
+    */
+   inline bool poll()
+   {
+      if (!this->pending)
+         return false;
+      this->pending = false; // cleared before the read; a new change after the read signals again
+      return this->service();
+   };
+
+   /**
+    * @ingroup group09
+    * @brief Returns the position (counts) of a given encoder
+    * @param encoder index returned by add
+    */
+   inline int32_t getPosition(uint8_t encoder) { return (encoder < this->count) ? this->encoders[encoder].position : 0; };
+
+   /**
+    * @ingroup group09
+    * @brief Sets the position (counts) of a given encoder
+    */
+   inline void setPosition(uint8_t encoder, int32_t position)
+   {
+      if (encoder < this->count)
+         this->encoders[encoder].position = position;
+   };
+
+   /**
+    * @ingroup group09
+    * @brief Returns the number of lost steps (invalid transitions) of a given encoder
+    */
+   inline uint16_t getMissedSteps(uint8_t encoder) { return (encoder < this->count) ? this->encoders[encoder].missed : 0; };
+
+   /**
+    * @ingroup group09
+    * @brief Returns the number of reads where the encoder pins had changed again after the interrupt capture
+    */
+   inline uint16_t getOverruns() { return this->overruns; };
+
+   /**
+    * @ingroup group09
+    * @brief Returns the number of encoders
+    */
+   inline uint8_t getCount() { return this->count; };
+};
+
+#endif // _PU2CLR_MCP23008_ENCODER_H
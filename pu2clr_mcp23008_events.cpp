@@ -0,0 +1,109 @@
+/**
+ * @file pu2clr_mcp23008_events.cpp
+ * @brief Interrupt event queue for the MCP23008 - implementation
+ */
+
+#include "pu2clr_mcp23008_events.h"
+
+/** @defgroup group04 MCP23008 interrupt events */
+
+/**
+ * @ingroup group04
+ * @brief Producer - reads INTF and INTCAP (single sequential read) and queues the record
+ * @details Nothing is queued if no pin caused the interrupt (INTF = 0). Reading INTCAP clears the interrupt.
+ * @param timestamp micros() at the interrupt 
+ * @return true if a record was queued
+ */
+bool MCPEventQueue::capture(uint32_t timestamp) {
+    mcp23008_event event;
+
+    if (!this->mcp->getInterruptCapture(&event.intf, &event.intcap) || event.intf == 0)
+        return false;
+    event.timestamp = timestamp;
+    return this->push(&event);
+}
+
+/**
+ * @ingroup group04
+ * @brief Producer - queues a record
+ * @param event record
+ * @return false if the queue is full (the record is lost and counted by getOverflows)
+ */
+bool MCPEventQueue::push(const mcp23008_event *event) {
+    uint8_t head = this->head;
+    uint8_t next = (head + 1) & (MCP_EVENT_QUEUE_SIZE - 1);
+
+    if (next == this->tail)
+    {
+        this->overflows++;
+        return false;
+    }
+    this->ring[head] = *event;
+    MCP_MEMORY_BARRIER(); // the record must be visible before the new head
+    this->head = next;
+    return true;
+}
+
+/**
+ * @ingroup group04
+ * @brief Consumer - removes the oldest record 
+ * @param event receives the record
+ * @return false if the queue is empty
+ */
+bool MCPEventQueue::pop(mcp23008_event *event) {
+    uint8_t tail = this->tail;
+
+    if (tail == this->head)
+        return false;
+    MCP_MEMORY_BARRIER(); // reads the record after the head
+    *event = this->ring[tail];
+    MCP_MEMORY_BARRIER();
+    this->tail = (tail + 1) & (MCP_EVENT_QUEUE_SIZE - 1);
+    return true;
+}
+
+/**
+ * @ingroup group04
+ * @brief Sets the handler of a given pin
+ * @param gpio pin (0 ~ 7)
+ * @param callback handler (0 removes it)
+ */
+void MCPEventQueue::attach(uint8_t gpio, MCPEventCallback callback) {
+    if (gpio > 7)
+        return;
+    this->callbacks[gpio] = callback;
+}
+
+/**
+ * @ingroup group04
+ * @brief Captures the signaled interrupt (see onInterrupt) and dispatches all queued records
+ * @details For each record, the handler of each pin set in INTF is called with the level captured by INTCAP. 
+ * @details Call it in the loop.
+ * @return uint8_t number of records dispatched
+ */
+uint8_t MCPEventQueue::pollEvents() {
+    mcp23008_event event;
+    uint8_t count = 0;
+
+    uint32_t timestamp;
+    bool pending;
+
+    // the 32 bit timestamp can be torn by onInterrupt on 8 bit MCUs; it is taken before pending is cleared (onInterrupt keeps the first time)
+    noInterrupts();
+    pending = this->pending;
+    timestamp = this->pendingTime;
+    this->pending = false;
+    interrupts();
+
+    if (pending)
+        this->capture(timestamp);
+
+    while (this->pop(&event))
+    {
+        for (uint8_t gpio = 0; gpio < 8; gpio++)
+            if (CHECK_BIT_HIGH(event.intf, gpio) && this->callbacks[gpio])
+                this->callbacks[gpio](gpio, CHECK_BIT_HIGH(event.intcap, gpio) != 0, &event);
+        count++;
+    }
+    return count;
+}
@@ -0,0 +1,106 @@
+/**
+ * @file pu2clr_mcp23008_events.h
+ * @brief Interrupt event queue for the MCP23008 
+ * @details Each MCP23008 interrupt becomes a record (timestamp, INTF, INTCAP). INTF and INTCAP are read together in a single sequential read.
+ * @details The records go to a single-producer / single-consumer ring buffer (lock-free). The producer is capture(); the consumer is pop() / pollEvents().
+ * @details On Arduino boards (AVR, most cores) the I2C cannot be used inside an ISR. In this case, the ISR only calls onInterrupt() and 
+ * @details pollEvents(), called in the loop, captures and dispatches the events. On boards / RTOS where the bus can be used by another task or thread, 
+ * @details that context can call capture() and the loop just consumes the records.
+ * @code
+ *   MCP mcp;
+ *   MCPEventQueue events(&mcp);
+ *
+ *   void isr() { events.onInterrupt(); }
+ *   void onButton(uint8_t gpio, bool level, const mcp23008_event *event) { ... }
+ *
+ *   void setup() {
+ *     mcp.setup(0x20, GPIO_INPUT);
+ *     mcp.setRegisterCache(true);
+ *     mcp.interruptGpioOn(MCP_GPIO0, 1);
+ *     events.attach(MCP_GPIO0, onButton);
+ *     attachInterrupt(digitalPinToInterrupt(2), isr, FALLING);
+ *   }
+ *   void loop() { events.pollEvents(); }
+ * @endcode
+ */
+
+#ifndef _PU2CLR_MCP23008_EVENTS_H
+#define _PU2CLR_MCP23008_EVENTS_H
+
+#include "pu2clr_mcp23008.h"
+
+#ifndef MCP_EVENT_QUEUE_SIZE
+#define MCP_EVENT_QUEUE_SIZE 16 //!< Number of records of the event queue (power of 2; up to 128)
+#endif
+
+#if (MCP_EVENT_QUEUE_SIZE < 2) || (MCP_EVENT_QUEUE_SIZE > 128) || (MCP_EVENT_QUEUE_SIZE & (MCP_EVENT_QUEUE_SIZE - 1))
+#error "MCP_EVENT_QUEUE_SIZE must be a power of 2 between 2 and 128 (the ring indexes are masked)"
+#endif
+
+/**
+ * @brief MCP23008 interrupt event record
+ */
+typedef struct
+{
+   uint32_t timestamp; //!< micros() at the interrupt (or at the capture)
+   uint8_t intf;       //!< INTF - pins that caused the interrupt
+   uint8_t intcap;     //!< INTCAP - GPIO value at the time the interrupt occurred
+} mcp23008_event;
+
+/**
+ * @brief Event handler 
+ * @param gpio pin that caused the interrupt (0 ~ 7)
+ * @param level pin level captured by INTCAP
+ * @param event the whole record
+ */
+typedef void (*MCPEventCallback)(uint8_t gpio, bool level, const mcp23008_event *event);
+
+/**
+ * @brief Interrupt event queue (single producer / single consumer)
+ */
+class MCPEventQueue
+{
+protected:
+   MCP *mcp;
+   mcp23008_event ring[MCP_EVENT_QUEUE_SIZE];
+   volatile uint8_t head = 0;          //!< next record to write (changed by the producer only)
+   volatile uint8_t tail = 0;          //!< next record to read (changed by the consumer only)
+   volatile bool pending = false;      //!< set by onInterrupt
+   volatile uint32_t pendingTime = 0;  //!< micros() at onInterrupt
+   volatile uint16_t overflows = 0;    //!< records lost because the queue was full
+   MCPEventCallback callbacks[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+
+public:
+   MCPEventQueue(MCP *mcp) : mcp(mcp) {};
+   bool capture(uint32_t timestamp);
+   bool push(const mcp23008_event *event);
+   bool pop(mcp23008_event *event);
+   uint8_t pollEvents();
+   void attach(uint8_t gpio, MCPEventCallback callback);
+
+   /**
+    * @ingroup group04
+    * @brief Signals an interrupt (ISR safe; no I2C traffic)
+    * @details Call it from the MCU interrupt handler connected to the MCP23008 INT pin. pollEvents will capture the event.
+    */
+   inline void onInterrupt()
+   {
+      if (!this->pending)
+         this->pendingTime = micros();
+      this->pending = true;
+   };
+
+   /**
+    * @ingroup group04
+    * @brief Returns the number of records in the queue
+    */
+   inline uint8_t available() { return (uint8_t)(this->head - this->tail) & (MCP_EVENT_QUEUE_SIZE - 1); };
+
+   /**
+    * @ingroup group04
+    * @brief Returns the number of records lost because the queue was full
+    */
+   inline uint16_t getOverflows() { return this->overflows; };
+};
+
+#endif // _PU2CLR_MCP23008_EVENTS_H
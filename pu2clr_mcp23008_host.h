@@ -0,0 +1,74 @@
+/**
+ * @file pu2clr_mcp23008_host.h
+ * @brief Minimal Arduino API replacement for non Arduino (Linux host) builds
+ * @details It provides the few Arduino functions used by the PU2CLR MCP23008 library (timing and the reset pin control).
+ * @details On a host there is no MCU pin to control the MCP23008 RESET. So, pinMode and digitalWrite do nothing.
+ * @details This file is not used when the library is built by the Arduino IDE.
+ */
+
+#ifndef _PU2CLR_MCP23008_HOST_H
+#define _PU2CLR_MCP23008_HOST_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <chrono>
+#include <thread>
+
+#ifndef LOW
+#define LOW 0
+#define HIGH 1
+#endif
+
+#ifndef INPUT
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+#endif
+
+/**
+ * @brief Returns the number of microseconds since the first call
+ */
+inline unsigned long micros()
+{
+   static const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+   return (unsigned long)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * @brief Returns the number of milliseconds since the first call
+ */
+inline unsigned long millis()
+{
+   return micros() / 1000UL;
+}
+
+inline void delay(unsigned long ms)
+{
+   std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+inline void delayMicroseconds(unsigned int us)
+{
+   std::this_thread::sleep_for(std::chrono::microseconds(us));
+}
+
+/**
+ * @brief There are no MCU interrupts on a host. The sections protected by noInterrupts / interrupts run as they are.
+ */
+inline void noInterrupts() {}
+inline void interrupts() {}
+
+inline void pinMode(int pin, int mode)
+{
+   (void)pin;
+   (void)mode;
+}
+
+inline void digitalWrite(int pin, int value)
+{
+   (void)pin;
+   (void)value;
+}
+
+#endif // _PU2CLR_MCP23008_HOST_H
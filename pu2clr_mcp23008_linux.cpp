@@ -0,0 +1,132 @@
+/**
+ * @file pu2clr_mcp23008_linux.cpp
+ * @brief Linux i2c-dev transport (/dev/i2c-N) implementation
+ */
+
+#include "pu2clr_mcp23008_linux.h"
+
+#if defined(__linux__) && !defined(ARDUINO)
+
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <linux/i2c.h>
+#include <linux/i2c-dev.h>
+
+/** @defgroup group11 MCP23008 Linux transport */
+
+/**
+ * @ingroup group11
+ * @brief Closes the i2c-dev device
+ */
+MCPLinuxI2CBus::~MCPLinuxI2CBus() {
+    if (this->fd >= 0)
+        close(this->fd);
+}
+
+/**
+ * @ingroup group11
+ * @brief Opens the i2c-dev device (only once)
+ * @details If the device cannot be opened, all transfers return MCP_BUS_ERROR. See isOpen.
+ */
+void MCPLinuxI2CBus::begin() {
+    if (this->fd < 0)
+        this->fd = open(this->device, O_RDWR);
+}
+
+/**
+ * @ingroup group11
+ * @brief Executes a combined transaction (write + repeated start + read) via I2C_RDWR
+ * @param address device address
+ * @param wdata bytes to write (0 = no write phase)
+ * @param wn number of bytes to write
+ * @param rdata buffer (0 = no read phase)
+ * @param rn number of bytes to read
+ * @return uint8_t bus status
+ */
+uint8_t MCPLinuxI2CBus::transfer(uint8_t address, uint8_t *wdata, uint8_t wn, uint8_t *rdata, uint8_t rn) {
+    struct i2c_msg msgs[2];
+    struct i2c_rdwr_ioctl_data rdwr;
+    int nmsgs = 0;
+
+    if (this->fd < 0)
+        return MCP_BUS_ERROR;
+
+    if (wdata)
+    {
+        msgs[nmsgs].addr = address;
+        msgs[nmsgs].flags = 0;
+        msgs[nmsgs].len = wn;
+        msgs[nmsgs].buf = wdata;
+        nmsgs++;
+    }
+    if (rdata)
+    {
+        msgs[nmsgs].addr = address;
+        msgs[nmsgs].flags = I2C_M_RD;
+        msgs[nmsgs].len = rn;
+        msgs[nmsgs].buf = rdata;
+        nmsgs++;
+    }
+    rdwr.msgs = msgs;
+    rdwr.nmsgs = nmsgs;
+
+    if (ioctl(this->fd, I2C_RDWR, &rdwr) < 0)
+    {
+        switch (errno)
+        {
+        case ENXIO:
+        case EREMOTEIO:
+            return MCP_BUS_NACK_ADDRESS;
+        case ETIMEDOUT:
+            return MCP_BUS_TIMEOUT;
+        default:
+            return MCP_BUS_ERROR;
+        }
+    }
+    return MCP_BUS_OK;
+}
+
+/**
+ * @ingroup group11
+ * @brief Checks if there is a device at a given address (zero-length write)
+ * @details Only the address is sent. A read would return GPIO or INTCAP if the device address pointer is there and clear a pending interrupt.
+ */
+uint8_t MCPLinuxI2CBus::probe(uint8_t address) {
+    uint8_t aux;
+    return this->transfer(address, &aux, 0, 0, 0);
+}
+
+/**
+ * @ingroup group11
+ * @brief Writes the register address followed by n bytes in a single transaction
+ * @return uint8_t bus status (MCP_BUS_ERROR if n > 254: the message length, register address included, is limited to 255 bytes)
+ */
+uint8_t MCPLinuxI2CBus::writeRegisters(uint8_t address, uint8_t reg, const uint8_t *data, uint8_t n) {
+    uint8_t buf[256];
+    if (n > 254)
+        return MCP_BUS_ERROR;
+    buf[0] = reg;
+    if (n > 0)
+        memcpy(&buf[1], data, n);
+    return this->transfer(address, buf, n + 1, 0, 0);
+}
+
+/**
+ * @ingroup group11
+ * @brief Writes the register address and reads n bytes in a single combined transaction (repeated start)
+ */
+uint8_t MCPLinuxI2CBus::readRegisters(uint8_t address, uint8_t reg, uint8_t *data, uint8_t n) {
+    return this->transfer(address, &reg, 1, data, n);
+}
+
+/**
+ * @ingroup group11
+ * @brief Reads n bytes from the current device address pointer
+ */
+uint8_t MCPLinuxI2CBus::readCurrent(uint8_t address, uint8_t *data, uint8_t n) {
+    return this->transfer(address, 0, 0, data, n);
+}
+
+#endif
@@ -0,0 +1,49 @@
+/**
+ * @file pu2clr_mcp23008_linux.h
+ * @brief Linux i2c-dev transport (/dev/i2c-N)
+ * @details MCPBus implementation based on the Linux i2c-dev interface (Raspberry Pi and other Linux boards).
+ * @details The register reads use the I2C_RDWR ioctl (register address write + repeated start + read in one combined transaction).
+ * @details The bus clock is set by the Linux device tree / kernel module. So setClock does nothing.
+ * @code
+ *   MCPLinuxI2CBus i2c("/dev/i2c-1");
+ *   MCP mcp;
+ *   mcp.setBus(&i2c);
+ *   mcp.setup(0x20);
+ * @endcode
+ */
+
+#ifndef _PU2CLR_MCP23008_LINUX_H
+#define _PU2CLR_MCP23008_LINUX_H
+
+#if defined(__linux__) && !defined(ARDUINO)
+
+#include "pu2clr_mcp23008.h"
+
+/**
+ * @brief MCPBus implementation based on the Linux i2c-dev interface
+ */
+class MCPLinuxI2CBus : public MCPBus
+{
+protected:
+   const char *device; //!< i2c-dev device (Example: /dev/i2c-1)
+   int fd = -1;        //!< file descriptor
+
+   uint8_t transfer(uint8_t address, uint8_t *wdata, uint8_t wn, uint8_t *rdata, uint8_t rn);
+
+public:
+   MCPLinuxI2CBus(const char *device = "/dev/i2c-1") : device(device) {};
+   ~MCPLinuxI2CBus();
+   void begin();
+   uint8_t probe(uint8_t address);
+   uint8_t writeRegisters(uint8_t address, uint8_t reg, const uint8_t *data, uint8_t n);
+   uint8_t readRegisters(uint8_t address, uint8_t reg, uint8_t *data, uint8_t n);
+   uint8_t readCurrent(uint8_t address, uint8_t *data, uint8_t n);
+
+   /**
+    * @brief Checks if the i2c-dev device is open
+    */
+   inline bool isOpen() { return this->fd >= 0; };
+};
+
+#endif
+#endif // _PU2CLR_MCP23008_LINUX_H
@@ -0,0 +1,148 @@
+/**
+ * @file pu2clr_mcp23008_monitor.cpp
+ * @brief Bus instrumentation - implementation
+ */
+
+#include "pu2clr_mcp23008_monitor.h"
+
+/** @defgroup group06 MCP23008 bus instrumentation */
+
+/**
+ * @ingroup group06
+ * @brief Clears all counters
+ */
+void MCPBusMonitor::resetStats() {
+    memset(&this->stats, 0, sizeof(this->stats));
+    this->stats.latencyMin = 0xFFFFFFFF;
+}
+
+/**
+ * @ingroup group06
+ * @brief Returns the modeled time (us) the measured traffic takes on an I2C bus at a given clock
+ * @details Each message costs START + device address byte + STOP; each byte costs 9 bits (8 bits + ACK).
+ * @param clock I2C clock in Hz (100000, 400000, 1700000 etc)
+ * @return uint32_t time in us
+ */
+uint32_t MCPBusMonitor::getBusTime(long clock) {
+    uint64_t bits = 9ULL * (this->stats.frames + this->stats.bytesWritten + this->stats.bytesRead) + 2ULL * this->stats.frames;
+    return (uint32_t)((bits * 1000000ULL) / (uint64_t)clock);
+}
+
+/**
+ * @ingroup group06
+ * @brief Updates the counters after a transport operation
+ * @param start micros() before the operation
+ * @param status operation status
+ * @param frames I2C messages
+ * @param written bytes written
+ * @param read bytes read
+ */
+void MCPBusMonitor::record(uint32_t start, uint8_t status, uint8_t frames, uint8_t written, uint8_t read) {
+    uint32_t latency = micros() - start;
+    uint8_t bucket = 0;
+
+    this->stats.transactions++;
+    this->stats.frames += frames;
+    this->stats.bytesWritten += written;
+    this->stats.bytesRead += read;
+    if (status == MCP_BUS_NACK_ADDRESS || status == MCP_BUS_NACK_DATA)
+        this->stats.nacks++;
+    else if (status != MCP_BUS_OK)
+        this->stats.errors++;
+
+    if (latency < this->stats.latencyMin)
+        this->stats.latencyMin = latency;
+    if (latency > this->stats.latencyMax)
+        this->stats.latencyMax = latency;
+    this->stats.latencySum += latency;
+    while (bucket < MCP_LATENCY_BUCKETS - 1 && latency >= (64UL << bucket))
+        bucket++;
+    this->stats.histogram[bucket]++;
+}
+
+/**
+ * @ingroup group06
+ * @brief Counts the registers reached by the bytes of a transfer and follows the device address pointer
+ * @details With SEQOP = 0 the address pointer increments after each byte (it rolls over to IODIR after OLAT). With SEQOP = 1 it stays.
+ * @details A write to IOCON takes effect on the next byte.
+ * @param address device address
+ * @param reg first register
+ * @param data bytes written (0 = read)
+ * @param n number of bytes
+ */
+void MCPBusMonitor::countRegisters(uint8_t address, uint8_t reg, const uint8_t *data, uint8_t n) {
+    uint8_t device = address & 0x07;
+
+    for (uint8_t i = 0; i < n && reg <= REG_OLAT; i++)
+    {
+        bool sequential = !(this->iocon[device] & IOCON_SEQOP);
+        this->stats.registerAccess[reg]++;
+        if (data && reg == REG_IOCON)
+            this->iocon[device] = data[i];
+        if (sequential)
+            reg = (reg + 1) % MCP_REG_COUNT;
+    }
+    this->pointer[device] = reg;
+}
+
+void MCPBusMonitor::begin() {
+    this->bus->begin();
+}
+
+void MCPBusMonitor::setClock(long freq) {
+    this->bus->setClock(freq);
+}
+
+bool MCPBusMonitor::isBusy() {
+    return this->bus->isBusy();
+}
+
+/**
+ * @ingroup group06
+ * @brief Measured probe
+ */
+uint8_t MCPBusMonitor::probe(uint8_t address) {
+    uint32_t start = micros();
+    uint8_t status = this->bus->probe(address);
+    this->record(start, status, 1, 0, 0);
+    return status;
+}
+
+/**
+ * @ingroup group06
+ * @brief Measured register write
+ */
+uint8_t MCPBusMonitor::writeRegisters(uint8_t address, uint8_t reg, const uint8_t *data, uint8_t n) {
+    uint32_t start = micros();
+    uint8_t status = this->bus->writeRegisters(address, reg, data, n);
+    this->record(start, status, 1, n + 1, 0);
+    if (status == MCP_BUS_OK)
+        this->countRegisters(address, reg, data, n);
+    return status;
+}
+
+/**
+ * @ingroup group06
+ * @brief Measured register read
+ */
+uint8_t MCPBusMonitor::readRegisters(uint8_t address, uint8_t reg, uint8_t *data, uint8_t n) {
+    uint32_t start = micros();
+    uint8_t status = this->bus->readRegisters(address, reg, data, n);
+    this->record(start, status, 2, 1, n);
+    if (status == MCP_BUS_OK)
+        this->countRegisters(address, reg, 0, n);
+    return status;
+}
+
+/**
+ * @ingroup group06
+ * @brief Measured read from the current device address pointer
+ */
+uint8_t MCPBusMonitor::readCurrent(uint8_t address, uint8_t *data, uint8_t n) {
+    uint32_t start = micros();
+    uint8_t status = this->bus->readCurrent(address, data, n);
+    this->record(start, status, 1, 0, n);
+    if (status == MCP_BUS_OK)
+        this->countRegisters(address, this->pointer[address & 0x07], 0, n);
+    return status;
+}
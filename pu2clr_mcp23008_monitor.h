@@ -0,0 +1,88 @@
+/**
+ * @file pu2clr_mcp23008_monitor.h
+ * @brief Bus instrumentation (transaction counters, byte counts and latency histogram)
+ * @details MCPBusMonitor is a MCPBus that wraps another transport and measures everything that goes through it: 
+ * @details the register accesses (getRegister, setRegister), the bursts, the GPIO stream and the device scan. 
+ * @details It costs nothing if it is not used (the MCP class does not depend on it). 
+ * @details The per register counters follow the IOCON SEQOP bit and the address pointer of each device (0x20 ~ 0x27) as seen in the traffic: 
+ * @details a repeated transfer (SEQOP = 1) counts its register once per byte and a current address read counts the registers it reads. 
+ * @details The devices are assumed to start in the Power-on Reset state (SEQOP = 0; address pointer on IODIR).
+ * @code
+ *   MCPBusMonitor monitor(MCP::defaultBus());   // wraps the Arduino Wire transport
+ *   mcp.setBus(&monitor);
+ *   mcp.setup(0x20);
+ *   ...
+ *   const mcp23008_bus_stats *stats = monitor.getStats();
+ *   Serial.print(stats->transactions);
+ *   monitor.resetStats();
+ * @endcode
+ */
+
+#ifndef _PU2CLR_MCP23008_MONITOR_H
+#define _PU2CLR_MCP23008_MONITOR_H
+
+#include "pu2clr_mcp23008.h"
+
+#ifndef MCP_LATENCY_BUCKETS
+#define MCP_LATENCY_BUCKETS 8 //!< Latency histogram buckets. Bucket n counts latencies below (64 << n) us; the last one counts the rest.
+#endif
+
+/**
+ * @brief Bus statistics
+ */
+typedef struct
+{
+   uint32_t transactions;                    //!< transport operations (probe, write, read, current read)
+   uint32_t frames;                          //!< I2C messages (START + device address byte). A register read is two messages.
+   uint32_t bytesWritten;                    //!< bytes written (register address + data)
+   uint32_t bytesRead;                       //!< bytes read
+   uint16_t nacks;                           //!< MCP_BUS_NACK_ADDRESS and MCP_BUS_NACK_DATA
+   uint16_t errors;                          //!< other non MCP_BUS_OK status
+   uint32_t registerAccess[MCP_REG_COUNT];   //!< accesses per register (each byte of a transfer counts on the register it reaches)
+   uint32_t latencyMin;                      //!< us
+   uint32_t latencyMax;                      //!< us
+   uint32_t latencySum;                      //!< us (latencySum / transactions = average)
+   uint32_t histogram[MCP_LATENCY_BUCKETS];  //!< latency histogram
+} mcp23008_bus_stats;
+
+/**
+ * @brief MCPBus that measures another transport
+ */
+class MCPBusMonitor : public MCPBus
+{
+protected:
+   MCPBus *bus; //!< measured transport
+   mcp23008_bus_stats stats;
+   uint8_t iocon[8] = {0, 0, 0, 0, 0, 0, 0, 0};    //!< IOCON of each device (address & 7) as seen in the traffic
+   uint8_t pointer[8] = {0, 0, 0, 0, 0, 0, 0, 0};  //!< address pointer of each device
+
+   void record(uint32_t start, uint8_t status, uint8_t frames, uint8_t written, uint8_t read);
+   void countRegisters(uint8_t address, uint8_t reg, const uint8_t *data, uint8_t n);
+
+public:
+   MCPBusMonitor(MCPBus *bus) : bus(bus) { this->resetStats(); };
+   void resetStats();
+   uint32_t getBusTime(long clock);
+   void begin();
+   void setClock(long freq);
+   bool isBusy();
+   uint8_t probe(uint8_t address);
+   uint8_t writeRegisters(uint8_t address, uint8_t reg, const uint8_t *data, uint8_t n);
+   uint8_t readRegisters(uint8_t address, uint8_t reg, uint8_t *data, uint8_t n);
+   uint8_t readCurrent(uint8_t address, uint8_t *data, uint8_t n);
+
+   /**
+    * @ingroup group06
+    * @brief Returns the statistics
+    * @return const mcp23008_bus_stats* 
+    */
+   inline const mcp23008_bus_stats *getStats() { return &this->stats; };
+
+   /**
+    * @ingroup group06
+    * @brief Returns the average latency (us)
+    */
+   inline uint32_t getAverageLatency() { return (this->stats.transactions) ? this->stats.latencySum / this->stats.transactions : 0; };
+};
+
+#endif // _PU2CLR_MCP23008_MONITOR_H
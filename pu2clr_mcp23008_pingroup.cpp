@@ -0,0 +1,177 @@
+/**
+ * @file pu2clr_mcp23008_pingroup.cpp
+ * @brief Pin groups - implementation
+ */
+
+#include "pu2clr_mcp23008_pingroup.h"
+
+/** @defgroup group13 MCP23008 pin groups */
+
+/**
+ * @ingroup group13
+ * @brief Configures the group
+ * @details Builds the nibble tables and sets the direction of the pins (input pins get the internal pull up resistors).
+ * @details The strobe pin is an output (low).
+ * @param pins GPIO of each logical bit (pins[0] = logical bit 0)
+ * @param count number of pins (1 ~ 8)
+ * @param output true = output pins; false = input pins
+ * @param strobe strobe GPIO (-1 = no strobe)
+ * @return false if the pins are invalid
+ */
+bool MCPPinGroup::setup(const uint8_t *pins, uint8_t count, bool output, int8_t strobe) {
+    uint8_t mask = 0, bit, v, iodir;
+
+    if (count == 0 || count > 8 || strobe > 7)
+        return false;
+    for (uint8_t i = 0; i < count; i++)
+    {
+        if (pins[i] > 7 || (mask & (1 << pins[i])) || pins[i] == strobe)
+            return false;
+        mask |= 1 << pins[i];
+    }
+    this->count = count;
+    this->pinMask = mask;
+    this->strobeMask = (strobe >= 0) ? (1 << strobe) : 0;
+
+    for (v = 0; v < 16; v++)
+    {
+        this->outLow[v] = this->outHigh[v] = this->inLow[v] = this->inHigh[v] = 0;
+        for (bit = 0; bit < count; bit++)
+        {
+            if (bit < 4 && (v & (1 << bit)))
+                this->outLow[v] |= 1 << pins[bit];
+            if (bit >= 4 && (v & (1 << (bit - 4))))
+                this->outHigh[v] |= 1 << pins[bit];
+            if (pins[bit] < 4 && (v & (1 << pins[bit])))
+                this->inLow[v] |= 1 << bit;
+            if (pins[bit] >= 4 && (v & (1 << (pins[bit] - 4))))
+                this->inHigh[v] |= 1 << bit;
+        }
+    }
+
+    iodir = this->mcp->getRegister(REG_IODIR) & ~this->strobeMask;
+    if (this->strobeMask)
+        this->mcp->setRegister(REG_GPIO, this->mcp->getRegister(REG_OLAT) & ~this->strobeMask);
+    if (output)
+        this->mcp->setRegister(REG_IODIR, iodir & ~mask);
+    else
+    {
+        this->mcp->setRegister(REG_IODIR, iodir | mask);
+        this->mcp->setRegister(REG_GPPU, this->mcp->getRegister(REG_GPPU) | mask);
+    }
+    return true;
+}
+
+/**
+ * @ingroup group13
+ * @brief Returns the OLAT bits that are not part of the group (the strobe is low)
+ * @details From the OLAT shadow register when the register cache is enabled (no I2C traffic).
+ */
+uint8_t MCPPinGroup::base() {
+    return this->mcp->getRegister(REG_OLAT) & ~(this->pinMask | this->strobeMask);
+}
+
+/**
+ * @ingroup group13
+ * @brief Writes a value to the group (single OLAT write; no strobe)
+ * @param value logical value
+ */
+void MCPPinGroup::write(uint8_t value) {
+    this->mcp->setRegister(REG_GPIO, this->base() | this->toPhysical(value));
+}
+
+/**
+ * @ingroup group13
+ * @brief Writes a value and pulses the strobe (data, data + strobe, data) in a single I2C transaction
+ * @details Refused during a batch (see MCP::beginBatch): the strobe pulse cannot be staged.
+ * @param value logical value
+ * @return true if written; false during a batch or if the transfer failed
+ */
+bool MCPPinGroup::writeStrobed(uint8_t value) {
+    uint8_t data = this->base() | this->toPhysical(value);
+    uint8_t buf[3] = {data, (uint8_t)(data | this->strobeMask), data};
+    return this->mcp->writeRepeated(REG_GPIO, buf, 3) == 3;
+}
+
+/**
+ * @ingroup group13
+ * @brief Writes a byte as two strobed nibbles (high nibble first) in a single I2C transaction
+ * @details The nibbles go to the logical bits 0 ~ 3. The logical bits 4 ~ 7 get the upper value during both nibbles (Example: HD44780 RS).
+ * @details Refused during a batch (see MCP::beginBatch): the strobe pulses cannot be staged.
+ * @param value byte
+ * @param upper value of the logical bits 4 ~ 7 (bits 0 ~ 3 are ignored)
+ * @return true if written; false during a batch or if the transfer failed
+ */
+bool MCPPinGroup::writeNibbles(uint8_t value, uint8_t upper) {
+    uint8_t b = this->base();
+    uint8_t high = b | this->toPhysical((upper & 0xF0) | (value >> 4));
+    uint8_t low = b | this->toPhysical((upper & 0xF0) | (value & 0x0F));
+    uint8_t buf[6] = {high, (uint8_t)(high | this->strobeMask), high, low, (uint8_t)(low | this->strobeMask), low};
+    return this->mcp->writeRepeated(REG_GPIO, buf, 6) == 6;
+}
+
+/**
+ * @ingroup group13
+ * @brief Reads the group (single GPIO read; a bare read in GPIO stream mode)
+ * @return uint8_t logical value
+ */
+uint8_t MCPPinGroup::read() {
+    return this->toLogical(this->mcp->getGPIOS());
+}
+
+/**
+ * @ingroup group13
+ * @brief Reads the group with the strobe high (strobe high, read, strobe low)
+ * @return uint8_t logical value
+ */
+uint8_t MCPPinGroup::readStrobed() {
+    uint8_t olat = this->mcp->getRegister(REG_OLAT);
+    uint8_t value;
+
+    this->mcp->setRegister(REG_GPIO, olat | this->strobeMask);
+    value = this->read();
+    this->mcp->setRegister(REG_GPIO, olat & ~this->strobeMask);
+    return value;
+}
+
+/**
+ * @ingroup group13
+ * @brief Sets the column group of the keypad matrix (this group = rows; outputs)
+ * @details The scan result has one bit per key. So rows x columns must not be greater than 16 (the columns can be on another device).
+ * @param columns the column group (inputs with pull up)
+ * @return false if both groups are not set up, if they share pins or if there are more than 16 keys (scanKeypad returns 0)
+ */
+bool MCPPinGroup::setupKeypad(MCPPinGroup *columns) {
+    this->columns = 0;
+    if (this->count == 0 || columns->count == 0 || (this->mcp == columns->mcp && (this->pinMask & columns->pinMask)))
+        return false;
+    if (this->count * columns->count > 16)
+        return false;
+    this->columns = columns;
+    return true;
+}
+
+/**
+ * @ingroup group13
+ * @brief Scans the keypad matrix (see setupKeypad)
+ * @details For each row: the row goes low and the others high (one write), then the columns are read (one read).
+ * @details At the end all rows stay low, so any key press changes a column (interrupt-on-change can wake the next scan).
+ * @return uint16_t bit (row x number of columns + column) is 1 if the key is pressed (0 if the keypad is not set up)
+ */
+uint16_t MCPPinGroup::scanKeypad() {
+    uint16_t keys = 0;
+    uint8_t cols, all, pressed;
+
+    if (!this->columns)
+        return 0;
+    cols = this->columns->getCount();
+    all = (uint8_t)((1 << cols) - 1);
+    for (uint8_t row = 0; row < this->count; row++)
+    {
+        this->write(~(1 << row));
+        pressed = ~this->columns->read() & all;
+        keys |= (uint16_t)pressed << (row * cols);
+    }
+    this->write(0);
+    return keys;
+}
@@ -0,0 +1,88 @@
+/**
+ * @file pu2clr_mcp23008_pingroup.h
+ * @brief Pin groups: parallel byte / nibble wide I/O on the MCP23008 (LCD HD44780, keypad matrix etc)
+ * @details A pin group maps up to 8 logical bits to any GPIO pins. The logical to physical mapping (and back) uses precomputed nibble tables,
+ * @details so a group write is a single OLAT write and a group read is a single GPIO read, instead of one gpioWrite / gpioRead per line.
+ * @details A strobe pin (Example: HD44780 E) can be added. Strobed writes send data, data + strobe and data as repeated GPIO bytes
+ * @details in a single I2C transaction (see MCP::writeRepeated). writeNibbles sends both nibbles of a byte (4 bit LCD mode) in the same transaction.
+ * @details Strobed writes are refused during a batch (MCP::beginBatch): the pulse cannot be staged.
+ * @details Keypad: scanKeypad drives one row low at a time and reads the columns: one write and one read per row (not one per key).
+ * @details Call MCP::beginGpioStream once: the Sequential Operation stays disabled (no IOCON writes around each strobed write) and the
+ * @details reads are bare reads (no register address write). Out of the stream mode, each strobed write also sets and restores IOCON SEQOP
+ * @details (3 transactions): the address pointer cannot stay on GPIO while the Sequential Operation is enabled.
+ * @code
+ *   MCP mcp;
+ *   MCPPinGroup lcd(&mcp), rows(&mcp), columns(&mcp);
+ *
+ *   const uint8_t lcdPins[] = {MCP_GPIO3, MCP_GPIO4, MCP_GPIO5, MCP_GPIO6, MCP_GPIO1};  // D4, D5, D6, D7 and RS (logical bit 4)
+ *   lcd.setup(lcdPins, 5, true, MCP_GPIO2);                                            // E on GPIO 2
+ *   lcd.writeNibbles('A', 0x10);                                                       // RS = 1; 1 I2C transaction
+ *
+ *   const uint8_t rowPins[] = {0, 1, 2, 3}, colPins[] = {4, 5, 6, 7};
+ *   rows.setup(rowPins, 4, true);
+ *   columns.setup(colPins, 4, false);       // inputs with pull up
+ *   rows.setupKeypad(&columns);             // up to 16 keys (rows x columns)
+ *   uint16_t keys = rows.scanKeypad();      // bit (row * 4 + column) = key pressed
+ * @endcode
+ */
+
+#ifndef _PU2CLR_MCP23008_PINGROUP_H
+#define _PU2CLR_MCP23008_PINGROUP_H
+
+#include "pu2clr_mcp23008.h"
+
+/**
+ * @brief Group of GPIO pins handled as a parallel port
+ */
+class MCPPinGroup
+{
+protected:
+   MCP *mcp;
+   uint8_t count = 0;       //!< number of pins (logical bits)
+   uint8_t pinMask = 0;     //!< physical pins of the group
+   uint8_t strobeMask = 0;  //!< physical strobe pin (0 = no strobe)
+   MCPPinGroup *columns = 0; //!< column group of the keypad (see setupKeypad)
+   uint8_t outLow[16];      //!< logical bits 0 ~ 3 -> physical pins
+   uint8_t outHigh[16];     //!< logical bits 4 ~ 7 -> physical pins
+   uint8_t inLow[16];       //!< physical GPIO 0 ~ 3 -> logical bits
+   uint8_t inHigh[16];      //!< physical GPIO 4 ~ 7 -> logical bits
+
+   uint8_t base();
+
+public:
+   MCPPinGroup(MCP *mcp) : mcp(mcp) {};
+   bool setup(const uint8_t *pins, uint8_t count, bool output = true, int8_t strobe = -1);
+   void write(uint8_t value);
+   bool writeStrobed(uint8_t value);
+   bool writeNibbles(uint8_t value, uint8_t upper = 0);
+   uint8_t read();
+   uint8_t readStrobed();
+   bool setupKeypad(MCPPinGroup *columns);
+   uint16_t scanKeypad();
+
+   /**
+    * @ingroup group13
+    * @brief Converts a logical value into the physical GPIO bits of the group
+    */
+   inline uint8_t toPhysical(uint8_t value) { return this->outLow[value & 0x0F] | this->outHigh[value >> 4]; };
+
+   /**
+    * @ingroup group13
+    * @brief Converts a GPIO value into the logical value of the group
+    */
+   inline uint8_t toLogical(uint8_t gpio) { return this->inLow[gpio & 0x0F] | this->inHigh[gpio >> 4]; };
+
+   /**
+    * @ingroup group13
+    * @brief Returns the number of pins of the group
+    */
+   inline uint8_t getCount() { return this->count; };
+
+   /**
+    * @ingroup group13
+    * @brief Returns the physical pins of the group (bit mask)
+    */
+   inline uint8_t getPinMask() { return this->pinMask; };
+};
+
+#endif // _PU2CLR_MCP23008_PINGROUP_H
@@ -0,0 +1,195 @@
+/**
+ * @file pu2clr_mcp23008_pwm.cpp
+ * @brief Software PWM scheduler - implementation
+ */
+
+#include "pu2clr_mcp23008_pwm.h"
+
+/** @defgroup group12 MCP23008 software PWM */
+
+/**
+ * @ingroup group12
+ * @brief Starts the PWM scheduler
+ * @details The PWM pins become outputs, driven low (their OLAT bits are cleared before IODIR is written). All duty cycles start at 0. 
+ * @details The other output pins keep their OLAT values.
+ * @details The register cache is enabled: each edge reads the other OLAT bits from the OLAT shadow register (no I2C read).
+ * @param mask PWM pins (bit mask)
+ * @param frequency PWM frequency (Hz). See getMaxFrequency
+ * @param resolution steps (ticks) per period (2 ~ 255)
+ */
+void MCPPwm::setup(uint8_t mask, uint32_t frequency, uint8_t resolution) {
+    this->mask = mask;
+    this->resolution = (resolution < 2) ? 2 : resolution;
+    this->periodUs = 1000000UL / ((frequency) ? frequency : 1);
+    memset(this->duty, 0, sizeof(this->duty));
+
+    this->mcp->setRegisterCache(true);
+    this->mcp->setRegister(REG_OLAT, this->mcp->getRegister(REG_OLAT) & ~mask);
+    this->mcp->setRegister(REG_IODIR, this->mcp->getRegister(REG_IODIR) & ~mask);
+
+    this->written = false;
+    this->tickCount = 0;
+    this->periodStart = micros() - this->periodUs; // the first update starts a period
+    this->compute();
+}
+
+/**
+ * @ingroup group12
+ * @brief Sets the duty cycle of a given channel
+ * @details The new schedule is used from the next period on.
+ * @param gpio PWM pin (0 ~ 7)
+ * @param duty 0 (always off) ~ resolution (always on)
+ */
+void MCPPwm::setDuty(uint8_t gpio, uint8_t duty) {
+    if (gpio > 7 || !(this->mask & (1 << gpio)))
+        return;
+    this->duty[gpio] = (duty > this->resolution) ? this->resolution : duty;
+    this->compute();
+}
+
+/**
+ * @ingroup group12
+ * @brief Computes the schedule of the next period
+ * @details Edge 0: all channels with duty > 0 on. Then, one edge per distinct duty value (ascending), turning off the channels with that duty.
+ * @details Only the PWM pin levels are stored (see run).
+ */
+void MCPPwm::compute() {
+    uint8_t order[8], n = 0, value, b, i, j, gpio;
+    mcp23008_pwm_edge *e;
+
+    this->swap = false; // the schedule below is not used until it is complete
+    MCP_MEMORY_BARRIER();
+    b = this->active ^ 1;
+    e = this->edges[b];
+
+    value = 0;
+    for (gpio = 0; gpio < 8; gpio++)
+    {
+        if (!(this->mask & (1 << gpio)) || this->duty[gpio] == 0)
+            continue;
+        value |= 1 << gpio;
+        if (this->duty[gpio] < this->resolution)
+        {   // insertion sort by duty (up to 8 channels)
+            for (i = n; i > 0 && this->duty[order[i - 1]] > this->duty[gpio]; i--)
+                order[i] = order[i - 1];
+            order[i] = gpio;
+            n++;
+        }
+    }
+
+    e[0].tick = 0;
+    e[0].value = value;
+    j = 1;
+    for (i = 0; i < n; i++)
+    {
+        value &= ~(1 << order[i]);
+        if (this->duty[order[i]] == e[j - 1].tick)
+            e[j - 1].value = value;  // same time: merged into the same write
+        else
+        {
+            e[j].tick = this->duty[order[i]];
+            e[j].value = value;
+            j++;
+        }
+    }
+    this->edgeCount[b] = j;
+
+    MCP_MEMORY_BARRIER();
+    this->swap = true;
+}
+
+/**
+ * @ingroup group12
+ * @brief Executes the edges due at a given tick
+ * @details Late edges (ticks already passed) are merged into a single write. A write that does not change OLAT is not sent.
+ * @details The OLAT bits that are not PWM pins come from the OLAT shadow register at write time (changes made by the user are kept).
+ * @param tick current tick of the period
+ * @param newPeriod true at the start of a period
+ * @return true if OLAT was written
+ */
+bool MCPPwm::run(uint8_t tick, bool newPeriod) {
+    mcp23008_pwm_edge *e;
+    int16_t pattern = -1;
+    uint8_t value;
+
+    if (newPeriod)
+    {
+        if (this->swap)
+        {
+            this->active ^= 1;
+            this->swap = false;
+        }
+        this->next = 0;
+    }
+
+    e = this->edges[this->active];
+    while (this->next < this->edgeCount[this->active] && e[this->next].tick <= tick)
+        pattern = e[this->next++].value;
+
+    if (pattern < 0)
+        return false;
+    value = (this->mcp->getRegister(REG_OLAT) & ~this->mask) | (uint8_t)pattern;
+    if (this->written && value == this->lastValue)
+        return false;
+
+    this->mcp->setRegister(REG_OLAT, value);
+    this->lastValue = value;
+    this->written = true;
+    return true;
+}
+
+/**
+ * @ingroup group12
+ * @brief Runs the scheduler based on micros(). Call it as often as possible (loop).
+ * @return true if OLAT was written
+ */
+bool MCPPwm::update() {
+    uint32_t elapsed = micros() - this->periodStart;
+    bool newPeriod = false;
+
+    if (elapsed >= this->periodUs)
+    {   // new period (the lost periods are skipped)
+        uint32_t periods = elapsed / this->periodUs;
+        this->periodStart += periods * this->periodUs;
+        elapsed -= periods * this->periodUs;
+        newPeriod = true;
+    }
+    return this->run((uint8_t)(elapsed * this->resolution / this->periodUs), newPeriod);
+}
+
+/**
+ * @ingroup group12
+ * @brief Advances the scheduler one tick
+ * @details Call it from a timer at frequency x resolution Hz, in a context where the I2C bus can be used (or in the loop via a flag set by the timer).
+ * @return true if OLAT was written
+ */
+bool MCPPwm::tick() {
+    bool written = this->run(this->tickCount, this->tickCount == 0);
+    if (++this->tickCount >= this->resolution)
+        this->tickCount = 0;
+    return written;
+}
+
+/**
+ * @ingroup group12
+ * @brief Returns the maximum PWM frequency for a given I2C clock and resolution
+ * @details An edge can happen at every tick, so a tick must be at least one OLAT write long (MCP_PWM_WRITE_BITS bit times).
+ * @param clock I2C clock (Hz)
+ * @param resolution steps per period
+ * @return uint32_t frequency (Hz)
+ */
+uint32_t MCPPwm::getMaxFrequency(long clock, uint8_t resolution) {
+    return (resolution) ? (uint32_t)clock / ((uint32_t)MCP_PWM_WRITE_BITS * resolution) : 0;
+}
+
+/**
+ * @ingroup group12
+ * @brief Returns the maximum resolution (steps per period) for a given I2C clock and PWM frequency
+ * @param clock I2C clock (Hz)
+ * @param frequency PWM frequency (Hz)
+ * @return uint8_t steps per period (up to 255; 0 if the frequency cannot be reached)
+ */
+uint8_t MCPPwm::getMaxResolution(long clock, uint32_t frequency) {
+    uint32_t steps = (frequency) ? (uint32_t)clock / ((uint32_t)MCP_PWM_WRITE_BITS * frequency) : 255;
+    return (steps > 255) ? 255 : (uint8_t)steps;
+}
@@ -0,0 +1,100 @@
+/**
+ * @file pu2clr_mcp23008_pwm.h
+ * @brief Software PWM scheduler for the MCP23008 output pins
+ * @details For each PWM period, the OLAT values of all 8 channels are precomputed as a sorted list of edges (tick, OLAT value).
+ * @details Channels that switch at the same tick are merged into the same edge. So, each edge is a single one byte OLAT write
+ * @details (at most 9 writes per period), instead of a read-modify-write per channel (turnGpioOn / turnGpioOff).
+ * @details The edges are executed by update() (micros() based; call it as often as possible) or by tick() (call it from a timer at the tick rate).
+ * @details Duty cycle changes are computed in a second list and take effect at the start of the next period (no glitches).
+ * @details The edges hold only the PWM pin levels. Each write keeps the other OLAT bits as they are in the OLAT shadow register, so the other
+ * @details output pins can be changed (turnGpioOn, gpioWrite etc) while the PWM is running. setup enables the register cache (see MCP::setRegisterCache).
+ * @details The maximum frequency is limited by the I2C bus: an edge can happen at every tick and each OLAT write takes MCP_PWM_WRITE_BITS bit times.
+ * @details See getMaxFrequency. Examples: 100kHz / 32 steps = 107Hz; 400kHz / 32 steps = 431Hz; 1.7MHz / 32 steps = 1831Hz.
+ * @code
+ *   MCP mcp;
+ *   MCPPwm pwm(&mcp);
+ *
+ *   void setup() {
+ *     mcp.setup(0x20, GPIO_OUTPUT, -1, 400000);
+ *     pwm.setup(0B11110000, 200, 32);  // GPIO 4 ~ 7; 200Hz; 32 steps
+ *     pwm.setDuty(MCP_GPIO4, 8);       // 25%
+ *     pwm.setDuty(MCP_GPIO5, 16);      // 50%
+ *   }
+ *   void loop() { pwm.update(); }
+ * @endcode
+ */
+
+#ifndef _PU2CLR_MCP23008_PWM_H
+#define _PU2CLR_MCP23008_PWM_H
+
+#include "pu2clr_mcp23008.h"
+
+#ifndef MCP_PWM_RESOLUTION
+#define MCP_PWM_RESOLUTION 32 //!< Default number of steps (ticks) per PWM period
+#endif
+
+#define MCP_PWM_WRITE_BITS 29 //!< I2C bit times of an OLAT write: START + 3 bytes (address, register, value) with ACK + STOP
+#define MCP_PWM_MAX_EDGES 9   //!< period start + one edge per channel
+
+/**
+ * @brief PWM edge (the PWM pin levels from a given tick on)
+ */
+typedef struct
+{
+   uint8_t tick;  //!< tick of the period (0 ~ resolution - 1)
+   uint8_t value; //!< PWM pin levels (the other OLAT bits are taken from the OLAT shadow register at write time)
+} mcp23008_pwm_edge;
+
+/**
+ * @brief Software PWM scheduler (8 channels)
+ */
+class MCPPwm
+{
+protected:
+   MCP *mcp;
+   uint8_t mask = 0;                     //!< PWM pins
+   uint8_t resolution = MCP_PWM_RESOLUTION;
+   uint8_t duty[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+   mcp23008_pwm_edge edges[2][MCP_PWM_MAX_EDGES]; //!< current and next period schedules
+   uint8_t edgeCount[2] = {0, 0};
+   uint8_t active = 0;                   //!< schedule of the current period
+   volatile bool swap = false;           //!< the other schedule must be used from the next period on
+   uint8_t next = 0;                     //!< next edge of the current period
+   uint8_t tickCount = 0;                //!< current tick (see tick)
+   uint8_t lastValue = 0;                //!< last OLAT value written (PWM and other pins)
+   bool written = false;                 //!< lastValue is valid
+   uint32_t periodUs = 0;                //!< period (us)
+   uint32_t periodStart = 0;             //!< micros() at the start of the current period
+
+   void compute();
+   bool run(uint8_t tick, bool newPeriod);
+
+public:
+   MCPPwm(MCP *mcp) : mcp(mcp) {};
+   void setup(uint8_t mask, uint32_t frequency, uint8_t resolution = MCP_PWM_RESOLUTION);
+   void setDuty(uint8_t gpio, uint8_t duty);
+   bool update();
+   bool tick();
+   static uint32_t getMaxFrequency(long clock, uint8_t resolution = MCP_PWM_RESOLUTION);
+   static uint8_t getMaxResolution(long clock, uint32_t frequency);
+
+   /**
+    * @ingroup group12
+    * @brief Returns the duty cycle of a given channel (0 ~ resolution)
+    */
+   inline uint8_t getDuty(uint8_t gpio) { return (gpio < 8) ? this->duty[gpio] : 0; };
+
+   /**
+    * @ingroup group12
+    * @brief Returns the number of OLAT writes per period of the current schedule
+    */
+   inline uint8_t getEdgeCount() { return this->edgeCount[this->active]; };
+
+   /**
+    * @ingroup group12
+    * @brief Returns the tick length (us) used by update
+    */
+   inline uint32_t getTickTime() { return this->periodUs / this->resolution; };
+};
+
+#endif // _PU2CLR_MCP23008_PWM_H
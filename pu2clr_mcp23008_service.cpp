@@ -0,0 +1,532 @@
+/**
+ * @file pu2clr_mcp23008_service.cpp
+ * @brief Linux service mode implementation
+ */
+
+#include "pu2clr_mcp23008_service.h"
+
+#if defined(__linux__) && !defined(ARDUINO)
+
+#include <future>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/ioctl.h>
+#include <linux/gpio.h>
+
+/** @defgroup group16 MCP23008 Linux service */
+
+/**
+ * @ingroup group16
+ * @brief Creates the service of a bus
+ * @param bus the transport shared by the devices (Example: MCPLinuxI2CBus)
+ */
+MCPService::MCPService(MCPBus *bus) : bus(bus), head(&stub), tail(&stub), poolNext(0), running(false), interruptPending(false), producers(0),
+                                      tickUs(MCP_SERVICE_TICK_US), queuedPins(0), requests(0), pinWrites(0), olatWrites(0), interrupts(0) {
+    this->stub.next.store(0);
+    for (uint8_t i = 0; i < MCP_SERVICE_POOL_SIZE; i++)
+        this->pool[i].used.store(false);
+    memset(this->setMask, 0, sizeof(this->setMask));
+    memset(this->clearMask, 0, sizeof(this->clearMask));
+    memset(this->waiting, 0, sizeof(this->waiting));
+}
+
+/**
+ * @ingroup group16
+ * @brief Stops the service thread and closes the file descriptors
+ */
+MCPService::~MCPService() {
+    this->stop();
+    if (this->lineFd >= 0)
+        close(this->lineFd);
+}
+
+/**
+ * @ingroup group16
+ * @brief Adds a device (call it before start)
+ * @details The device must use the bus of the service and must be set up (MCP::setup). The register cache is enabled:
+ * @details from now on only the service thread talks to the device. Do not call the MCP methods directly while the service runs.
+ * @param mcp the device
+ * @return uint8_t device index (0xFF if the service is running or full)
+ */
+uint8_t MCPService::addDevice(MCP *mcp) {
+    if (this->running.load() || this->count >= MCP_SERVICE_MAX_DEVICES)
+        return 0xFF;
+    mcp->setRegisterCache(true);
+    this->devices[this->count] = mcp;
+    return this->count++;
+}
+
+/**
+ * @ingroup group16
+ * @brief Subscribes to the interrupts of a device (call it before start)
+ * @param device device index (0xFF = all devices)
+ * @param subscriber function called (from the service thread) with INTF and INTCAP
+ * @param context user data
+ * @return false if the service is running or there is no room
+ */
+bool MCPService::subscribe(uint8_t device, MCPServiceSubscriber subscriber, void *context) {
+    if (this->running.load() || this->subscriberCount >= MCP_SERVICE_MAX_SUBSCRIBERS)
+        return false;
+    this->subscribers[this->subscriberCount].device = device;
+    this->subscribers[this->subscriberCount].subscriber = subscriber;
+    this->subscribers[this->subscriberCount].context = context;
+    this->subscriberCount++;
+    return true;
+}
+
+/**
+ * @ingroup group16
+ * @brief Selects the GPIO line connected to the MCP23008 INT pin (call it before start)
+ * @details Uses the GPIO character device (Example: /dev/gpiochip0) and its line request interface (uAPI v2). The line edges are watched
+ * @details by the service thread (epoll). With kernel headers older than 5.10 (no uAPI v2), the deprecated line event interface (v1) is used.
+ * @param chip GPIO character device
+ * @param line line offset
+ * @param activeLow true = the INT output is active low (falling edge); false = active high (rising edge)
+ * @return true if the line was requested
+ */
+bool MCPService::setInterruptLine(const char *chip, uint32_t line, bool activeLow) {
+#ifdef GPIO_V2_GET_LINE_IOCTL
+    struct gpio_v2_line_request request;
+#else
+    struct gpioevent_request request;
+#endif
+    int fd;
+
+    if (this->running.load() || (fd = open(chip, O_RDONLY | O_CLOEXEC)) < 0)
+        return false;
+    memset(&request, 0, sizeof(request));
+#ifdef GPIO_V2_GET_LINE_IOCTL
+    request.offsets[0] = line;
+    request.num_lines = 1;
+    request.config.flags = GPIO_V2_LINE_FLAG_INPUT | ((activeLow) ? GPIO_V2_LINE_FLAG_EDGE_FALLING : GPIO_V2_LINE_FLAG_EDGE_RISING);
+    strncpy(request.consumer, "pu2clr_mcp23008", sizeof(request.consumer) - 1);
+    if (ioctl(fd, GPIO_V2_GET_LINE_IOCTL, &request) < 0)
+#else
+    request.lineoffset = line;
+    request.handleflags = GPIOHANDLE_REQUEST_INPUT;
+    request.eventflags = (activeLow) ? GPIOEVENT_REQUEST_FALLING_EDGE : GPIOEVENT_REQUEST_RISING_EDGE;
+    strncpy(request.consumer_label, "pu2clr_mcp23008", sizeof(request.consumer_label) - 1);
+    if (ioctl(fd, GPIO_GET_LINEEVENT_IOCTL, &request) < 0)
+#endif
+    {
+        close(fd);
+        return false;
+    }
+    close(fd);
+    if (this->lineFd >= 0)
+        close(this->lineFd);
+    this->lineFd = request.fd;
+    return true;
+}
+
+/**
+ * @ingroup group16
+ * @brief Starts the service thread
+ * @details The thread scans the devices once before waiting, so an interrupt already pending (INT asserted, no new edge) is serviced.
+ * @return true if the thread is running
+ */
+bool MCPService::start() {
+    if (this->running.load())
+        return true;
+    if ((this->wakeFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK)) < 0)
+        return false;
+    this->running.store(true);
+    this->thread = std::thread(&MCPService::run, this);
+    return true;
+}
+
+/**
+ * @ingroup group16
+ * @brief Stops the service thread
+ * @details The requests already posted are executed (by the calling thread) before it returns. New requests are refused.
+ */
+void MCPService::stop() {
+    if (!this->running.exchange(false))
+        return;
+    this->wake();
+    this->thread.join();
+    while (this->producers.load() != 0)
+        std::this_thread::yield();   // a producer may still be pushing its request
+    this->drain();
+    close(this->wakeFd);
+    this->wakeFd = -1;
+}
+
+/**
+ * @ingroup group16
+ * @brief Wakes the service thread up
+ */
+void MCPService::wake() {
+    uint64_t one = 1;
+    if (write(this->wakeFd, &one, sizeof(one)) < 0)
+        return;   // the counter is already non zero (the thread will wake up anyway)
+}
+
+/**
+ * @ingroup group16
+ * @brief Reports an interrupt (the INTF / INTCAP of the devices are read by the service thread)
+ * @details Use it if the INT line is not a GPIO character device line (or to test with the simulated bus). Safe from any thread.
+ */
+void MCPService::notifyInterrupt() {
+    this->interruptPending.store(true);
+    this->producers++;
+    if (this->running.load())
+        this->wake();
+    this->producers--;
+}
+
+/**
+ * @ingroup group16
+ * @brief Takes a free request node from the pool (any thread; lock-free)
+ * @details Each producer starts at a different node, so concurrent producers seldom compete for the same one.
+ * @return mcp23008_service_request* 0 if all the nodes are in use
+ */
+mcp23008_service_request *MCPService::allocate() {
+    uint32_t start = this->poolNext.fetch_add(1, std::memory_order_relaxed);
+
+    for (uint32_t i = 0; i < MCP_SERVICE_POOL_SIZE; i++)
+    {
+        mcp23008_service_request *request = &this->pool[(start + i) % MCP_SERVICE_POOL_SIZE];
+        if (!request->used.load(std::memory_order_relaxed) && !request->used.exchange(true, std::memory_order_acquire))
+            return request;
+    }
+    return 0;
+}
+
+/**
+ * @ingroup group16
+ * @brief Adds a request to the MPSC queue (any thread; lock-free)
+ */
+void MCPService::push(mcp23008_service_request *request) {
+    request->next.store(0, std::memory_order_relaxed);
+    mcp23008_service_request *prev = this->head.exchange(request, std::memory_order_acq_rel);
+    prev->next.store(request, std::memory_order_release);
+}
+
+/**
+ * @ingroup group16
+ * @brief Removes the oldest request from the MPSC queue (service thread only)
+ * @return mcp23008_service_request* 0 if the queue is empty (or a producer is in the middle of a push)
+ */
+mcp23008_service_request *MCPService::pop() {
+    mcp23008_service_request *tail = this->tail;
+    mcp23008_service_request *next = tail->next.load(std::memory_order_acquire);
+
+    if (tail == &this->stub)
+    {
+        if (!next)
+            return 0;
+        this->tail = tail = next;
+        next = next->next.load(std::memory_order_acquire);
+    }
+    if (next)
+    {
+        this->tail = next;
+        return tail;
+    }
+    if (tail != this->head.load(std::memory_order_acquire))
+        return 0;
+    this->push(&this->stub);
+    next = tail->next.load(std::memory_order_acquire);
+    if (next)
+    {
+        this->tail = next;
+        return tail;
+    }
+    return 0;
+}
+
+/**
+ * @ingroup group16
+ * @brief Posts a request
+ * @return false if the service is not running, the device index is invalid or the pool is empty (MCP_SERVICE_POOL_SIZE requests pending)
+ */
+bool MCPService::submit(uint8_t type, uint8_t device, uint8_t reg, uint8_t mask, uint8_t value, MCPServiceCallback callback, void *context) {
+    mcp23008_service_request *request;
+
+    if (device >= this->count)
+        return false;
+    this->producers++;
+    if (!this->running.load())
+    {
+        this->producers--;
+        return false;
+    }
+    if (!(request = this->allocate()))
+    {
+        this->producers--;
+        return false;
+    }
+    request->link = 0;
+    request->type = type;
+    request->device = device;
+    request->reg = reg;
+    request->mask = mask;
+    request->value = value;
+    request->callback = callback;
+    request->context = context;
+    if (type == MCP_SERVICE_PINS)
+        this->queuedPins++;
+    this->push(request);
+    this->wake();
+    this->producers--;
+    return true;
+}
+
+/**
+ * @ingroup group16
+ * @brief Completion callback of the blocking calls (wakes the caller)
+ */
+static void mcpServiceResume(uint8_t status, uint8_t value, void *context) {
+    ((std::promise<uint16_t> *)context)->set_value((status << 8) | value);
+}
+
+/**
+ * @ingroup group16
+ * @brief Posts a request and waits for its completion
+ * @details From the service thread (subscriber or completion callback) the request would never be executed: it fails at once.
+ * @return uint16_t status (high byte) and value (low byte)
+ */
+uint16_t MCPService::call(uint8_t type, uint8_t device, uint8_t reg, uint8_t mask, uint8_t value) {
+    std::promise<uint16_t> done;
+    std::future<uint16_t> result = done.get_future();
+
+    if (std::this_thread::get_id() == this->thread.get_id())
+        return MCP_BUS_ERROR << 8;
+    if (!this->submit(type, device, reg, mask, value, mcpServiceResume, &done))
+        return MCP_BUS_ERROR << 8;
+    return result.get();
+}
+
+/**
+ * @ingroup group16
+ * @brief Finishes a request (calls the callback and gives the node back to the pool)
+ */
+void MCPService::complete(mcp23008_service_request *request, uint8_t status, uint8_t value) {
+    MCPServiceCallback callback = request->callback;
+    void *context = request->context;
+
+    request->used.store(false, std::memory_order_release);
+    if (callback)
+        callback(status, value, context);
+}
+
+/**
+ * @ingroup group16
+ * @brief Sets / clears output pins and waits for the OLAT write (any thread)
+ * @details Pin writes to the same device posted in the same scheduling tick share a single OLAT write.
+ * @param device device index
+ * @param mask pins to change
+ * @param value new levels of the pins in mask
+ * @return uint8_t bus status
+ */
+uint8_t MCPService::writePins(uint8_t device, uint8_t mask, uint8_t value) {
+    return this->call(MCP_SERVICE_PINS, device, 0, mask, value) >> 8;
+}
+
+/**
+ * @ingroup group16
+ * @brief Sets / clears output pins without waiting (any thread)
+ * @param device device index
+ * @param mask pins to change
+ * @param value new levels of the pins in mask
+ * @param callback called from the service thread after the OLAT write (optional)
+ * @param context user data
+ * @return false if the request was not posted
+ */
+bool MCPService::postPins(uint8_t device, uint8_t mask, uint8_t value, MCPServiceCallback callback, void *context) {
+    return this->submit(MCP_SERVICE_PINS, device, 0, mask, value, callback, context);
+}
+
+/**
+ * @ingroup group16
+ * @brief Writes a register and waits for the write (any thread)
+ * @param device device index
+ * @param reg register
+ * @param value value
+ * @return uint8_t bus status
+ */
+uint8_t MCPService::setRegister(uint8_t device, uint8_t reg, uint8_t value) {
+    return this->call(MCP_SERVICE_SET_REGISTER, device, reg, 0, value) >> 8;
+}
+
+/**
+ * @ingroup group16
+ * @brief Reads a register (any thread)
+ * @details The configuration registers come from the register cache of the device (no I2C traffic).
+ * @param device device index
+ * @param reg register
+ * @param value receives the register value (not changed if the read fails)
+ * @return uint8_t bus status
+ */
+uint8_t MCPService::getRegister(uint8_t device, uint8_t reg, uint8_t *value) {
+    uint16_t result = this->call(MCP_SERVICE_GET_REGISTER, device, reg, 0, 0);
+
+    if ((result >> 8) == MCP_BUS_OK)
+        *value = result & 0xFF;
+    return result >> 8;
+}
+
+/**
+ * @ingroup group16
+ * @brief Service thread: waits for requests and INT line events (epoll), then executes them
+ */
+void MCPService::run() {
+    struct epoll_event event, events[2];
+    int epollFd = epoll_create1(EPOLL_CLOEXEC);
+    uint64_t counter;
+    int n;
+
+    event.events = EPOLLIN;
+    event.data.fd = this->wakeFd;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, this->wakeFd, &event);
+    if (this->lineFd >= 0)
+    {
+        event.data.fd = this->lineFd;
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, this->lineFd, &event);
+    }
+
+    this->serviceInterrupt(false);   // the line events are edges: an INT asserted before start gives no event
+    while (this->running.load())
+    {
+        n = epoll_wait(epollFd, events, 2, -1);
+        for (int i = 0; i < n; i++)
+        {
+            if (events[i].data.fd == this->wakeFd)
+            {
+                if (read(this->wakeFd, &counter, sizeof(counter)) < 0)
+                    continue;
+            }
+            else
+            {
+#ifdef GPIO_V2_GET_LINE_IOCTL
+                struct gpio_v2_line_event data;
+#else
+                struct gpioevent_data data;
+#endif
+                if (read(this->lineFd, &data, sizeof(data)) == sizeof(data))
+                    this->interruptPending.store(true);
+            }
+        }
+        uint32_t tick = this->tickUs.load();
+        if (tick && this->queuedPins.load() && this->running.load())
+            std::this_thread::sleep_for(std::chrono::microseconds(tick)); // collects more pin writes (coalescing)
+        this->drain();
+        if (this->interruptPending.exchange(false))
+            this->serviceInterrupt();
+    }
+    close(epollFd);
+}
+
+/**
+ * @ingroup group16
+ * @brief Executes the requests in the queue
+ * @details Pin writes are merged per device. The merged value is written before any other request to the same device
+ * @details (the requests of a device are executed in order) and at the end of the tick.
+ */
+void MCPService::drain() {
+    mcp23008_service_request *request;
+    uint8_t d;
+
+    while ((request = this->pop()))
+    {
+        this->requests++;
+        d = request->device;
+        if (request->type == MCP_SERVICE_PINS)
+        {
+            this->queuedPins--;
+            this->pinWrites++;
+            this->setMask[d] = (this->setMask[d] & ~request->mask) | (request->value & request->mask);
+            this->clearMask[d] = (this->clearMask[d] & ~request->mask) | (~request->value & request->mask);
+            request->link = this->waiting[d];
+            this->waiting[d] = request;
+            continue;
+        }
+        this->flushPins(d);
+        this->execute(request);
+    }
+    for (d = 0; d < this->count; d++)
+        this->flushPins(d);
+}
+
+/**
+ * @ingroup group16
+ * @brief Writes the merged pin writes of a device (single OLAT write) and completes them
+ * @param device device index
+ */
+void MCPService::flushPins(uint8_t device) {
+    mcp23008_service_request *request = this->waiting[device], *aux;
+    MCP *mcp = this->devices[device];
+    uint8_t olat, status;
+
+    if (!request)
+        return;
+    olat = (mcp->getRegister(REG_OLAT) & ~this->clearMask[device]) | this->setMask[device];
+    status = mcp->writeRegister(REG_GPIO, olat);
+    this->olatWrites++;
+    this->setMask[device] = this->clearMask[device] = 0;
+    this->waiting[device] = 0;
+    while (request)
+    {
+        aux = request->link;
+        MCPService::complete(request, status, olat);
+        request = aux;
+    }
+}
+
+/**
+ * @ingroup group16
+ * @brief Executes a register request
+ */
+void MCPService::execute(mcp23008_service_request *request) {
+    MCP *mcp = this->devices[request->device];
+    uint8_t value = 0, status;
+
+    if (request->type == MCP_SERVICE_SET_REGISTER)
+    {
+        value = request->value;
+        status = mcp->writeRegister(request->reg, value);
+    }
+    else
+        status = mcp->readRegister(request->reg, &value);
+    MCPService::complete(request, status, value);
+}
+
+/**
+ * @ingroup group16
+ * @brief Reads INTF / INTCAP of the devices with interrupts enabled and calls the subscribers of the devices that fired
+ * @details The devices are scanned until a full scan finds INTF = 0 on all of them. On a shared edge-triggered line, a device that fires
+ * @details after its INTF was read keeps the line asserted and no new edge arrives. After MCP_SERVICE_MAX_PASSES scans, the event is
+ * @details signaled again (the other requests are executed in between).
+ * @param event true = an interrupt was reported (counted by getInterrupts); false = the scan made when the thread starts
+ */
+void MCPService::serviceInterrupt(bool event) {
+    uint8_t intf, intcap, passes = 0;
+    bool fired;
+
+    if (event)
+        this->interrupts++;
+    do
+    {
+        fired = false;
+        for (uint8_t d = 0; d < this->count; d++)
+        {
+            if (this->devices[d]->getRegister(REG_GPINTEN) == 0 || !this->devices[d]->getInterruptCapture(&intf, &intcap) || intf == 0)
+                continue;
+            fired = true;
+            for (uint8_t i = 0; i < this->subscriberCount; i++)
+                if (this->subscribers[i].device == d || this->subscribers[i].device == 0xFF)
+                    this->subscribers[i].subscriber(d, intf, intcap, this->subscribers[i].context);
+        }
+    } while (fired && ++passes < MCP_SERVICE_MAX_PASSES);
+
+    if (fired)
+    {
+        this->interruptPending.store(true);
+        this->wake();
+    }
+}
+
+#endif
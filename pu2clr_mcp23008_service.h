@@ -0,0 +1,214 @@
+/**
+ * @file pu2clr_mcp23008_service.h
+ * @brief Linux service mode: many threads share the MCP23008 devices of one bus
+ * @details The MCP class is not thread safe (shadow registers, GPIO stream state etc). MCPService owns the devices of one bus (/dev/i2c-N)
+ * @details and is the only thread that talks to them. Other threads post requests to a lock-free MPSC queue (many producers, one consumer).
+ * @details Pin writes to the same device are coalesced: all pin writes found in the queue at a scheduling tick become a single OLAT write.
+ * @details The INT line (GPIO character device, see setInterruptLine) is watched with epoll. When it is asserted, INTF / INTCAP of the devices
+ * @details with interrupts enabled are read and the subscribers are called (from the service thread). The devices are scanned again until
+ * @details a full scan finds no interrupt (on a shared edge-triggered line, a device that fires during the scan does not make a new edge).
+ * @details notifyInterrupt does the same without a GPIO line (tests with the simulated bus, other interrupt sources etc).
+ * @details The requests come from a fixed pool (MCP_SERVICE_POOL_SIZE): no heap allocation per request. When all the nodes are in use, the request is refused.
+ * @details Subscribers and completion callbacks run on the service thread: they may post requests (postPins) but must not wait for one
+ * @details (writePins, setRegister, getRegister return MCP_BUS_ERROR there instead of blocking the thread that would execute them).
+ * @details Only for Linux (not built by the Arduino IDE). Link with -pthread.
+ * @code
+ *   MCPLinuxI2CBus i2c("/dev/i2c-1");
+ *   MCP relays, inputs;
+ *   MCPService service(&i2c);
+ *
+ *   relays.setBus(&i2c);
+ *   relays.setup(0x20, GPIO_OUTPUT);
+ *   inputs.setBus(&i2c);
+ *   inputs.setup(0x21, GPIO_INPUT);
+ *   inputs.interruptGpioOn(MCP_GPIO0);
+ *
+ *   uint8_t r = service.addDevice(&relays);
+ *   uint8_t in = service.addDevice(&inputs);
+ *   service.subscribe(in, onInputChange);
+ *   service.setInterruptLine("/dev/gpiochip0", 17);  // MCP23008 INT on GPIO 17 (active low)
+ *   service.start();
+ *
+ *   // any thread
+ *   service.writePins(r, 0B00000011, 0B00000001);    // GPIO 0 = 1; GPIO 1 = 0
+ * @endcode
+ */
+
+#ifndef _PU2CLR_MCP23008_SERVICE_H
+#define _PU2CLR_MCP23008_SERVICE_H
+
+#if defined(__linux__) && !defined(ARDUINO)
+
+#include "pu2clr_mcp23008.h"
+#include <atomic>
+#include <thread>
+
+#define MCP_SERVICE_MAX_DEVICES 8      //!< Devices per service (bus)
+#define MCP_SERVICE_MAX_SUBSCRIBERS 8  //!< Interrupt subscribers per service
+
+#ifndef MCP_SERVICE_TICK_US
+#define MCP_SERVICE_TICK_US 1000       //!< Default scheduling tick (us): the time pin writes are collected before they are executed (see setTick)
+#endif
+
+#ifndef MCP_SERVICE_MAX_PASSES
+#define MCP_SERVICE_MAX_PASSES 8       //!< Maximum number of INTF scans per interrupt event (then the event is signaled again)
+#endif
+
+#ifndef MCP_SERVICE_POOL_SIZE
+#define MCP_SERVICE_POOL_SIZE 32       //!< Request nodes per service (requests posted and not completed yet)
+#endif
+
+#define MCP_SERVICE_PINS 0             //!< Request type: pin write (coalesced)
+#define MCP_SERVICE_SET_REGISTER 1     //!< Request type: register write
+#define MCP_SERVICE_GET_REGISTER 2     //!< Request type: register read
+
+/**
+ * @brief Request completion callback (called from the service thread)
+ * @param status bus status (MCP_BUS_OK = success)
+ * @param value register value (get register requests)
+ * @param context user data given with the request
+ */
+typedef void (*MCPServiceCallback)(uint8_t status, uint8_t value, void *context);
+
+/**
+ * @brief Interrupt subscriber (called from the service thread)
+ * @param device device index (see MCPService::addDevice)
+ * @param intf pins that caused the interrupt
+ * @param intcap GPIO value at the time of the interrupt
+ * @param context user data given to subscribe
+ */
+typedef void (*MCPServiceSubscriber)(uint8_t device, uint8_t intf, uint8_t intcap, void *context);
+
+/**
+ * @brief Service request (node of the MPSC queue)
+ */
+typedef struct mcp23008_service_request
+{
+   std::atomic<mcp23008_service_request *> next; //!< queue link
+   std::atomic<bool> used;                       //!< taken from the pool
+   mcp23008_service_request *link;               //!< pin writes waiting for the coalesced OLAT write
+   uint8_t type;
+   uint8_t device;
+   uint8_t reg;
+   uint8_t mask;
+   uint8_t value;
+   MCPServiceCallback callback;
+   void *context;
+} mcp23008_service_request;
+
+/**
+ * @brief Owner of the devices of one bus (one thread per bus)
+ */
+class MCPService
+{
+protected:
+   MCPBus *bus;
+   MCP *devices[MCP_SERVICE_MAX_DEVICES];
+   uint8_t count = 0;
+
+   struct
+   {
+      uint8_t device;
+      MCPServiceSubscriber subscriber;
+      void *context;
+   } subscribers[MCP_SERVICE_MAX_SUBSCRIBERS]; //!< interrupt subscribers
+   uint8_t subscriberCount = 0;
+
+   // MPSC queue (Vyukov intrusive queue): producers exchange head; the service thread owns tail
+   std::atomic<mcp23008_service_request *> head;
+   mcp23008_service_request *tail;
+   mcp23008_service_request stub;
+
+   // request nodes: producers claim a free node (used flag); the node is released after its completion
+   mcp23008_service_request pool[MCP_SERVICE_POOL_SIZE];
+   std::atomic<uint32_t> poolNext;   //!< where the next search for a free node starts
+
+   // coalesced pin writes (service thread only)
+   uint8_t setMask[MCP_SERVICE_MAX_DEVICES];
+   uint8_t clearMask[MCP_SERVICE_MAX_DEVICES];
+   mcp23008_service_request *waiting[MCP_SERVICE_MAX_DEVICES];
+
+   std::thread thread;
+   std::atomic<bool> running;
+   std::atomic<bool> interruptPending;
+   std::atomic<int> producers;  //!< threads inside submit
+   std::atomic<uint32_t> tickUs;
+   std::atomic<uint32_t> queuedPins;  //!< pin write requests posted and not taken from the queue yet
+   int wakeFd = -1;             //!< eventfd: new requests / interrupt notification / stop
+   int lineFd = -1;             //!< GPIO line event (INT)
+
+   std::atomic<uint32_t> requests;
+   std::atomic<uint32_t> pinWrites;
+   std::atomic<uint32_t> olatWrites;
+   std::atomic<uint32_t> interrupts;
+
+   mcp23008_service_request *allocate();
+   void push(mcp23008_service_request *request);
+   mcp23008_service_request *pop();
+   bool submit(uint8_t type, uint8_t device, uint8_t reg, uint8_t mask, uint8_t value, MCPServiceCallback callback, void *context);
+   uint16_t call(uint8_t type, uint8_t device, uint8_t reg, uint8_t mask, uint8_t value);
+   void wake();
+   void run();
+   void drain();
+   void execute(mcp23008_service_request *request);
+   void flushPins(uint8_t device);
+   void serviceInterrupt(bool event = true);
+   static void complete(mcp23008_service_request *request, uint8_t status, uint8_t value);
+
+public:
+   MCPService(MCPBus *bus);
+   ~MCPService();
+   uint8_t addDevice(MCP *mcp);
+   bool subscribe(uint8_t device, MCPServiceSubscriber subscriber, void *context = 0);
+   bool setInterruptLine(const char *chip, uint32_t line, bool activeLow = true);
+   bool start();
+   void stop();
+   void notifyInterrupt();
+
+   uint8_t writePins(uint8_t device, uint8_t mask, uint8_t value);
+   bool postPins(uint8_t device, uint8_t mask, uint8_t value, MCPServiceCallback callback = 0, void *context = 0);
+   uint8_t setRegister(uint8_t device, uint8_t reg, uint8_t value);
+   uint8_t getRegister(uint8_t device, uint8_t reg, uint8_t *value);
+
+   /**
+    * @ingroup group16
+    * @brief Sets the scheduling tick (any thread)
+    * @details After a wake up, if there are pin writes in the queue, the service thread waits tickUs before executing the queue, so more pin writes
+    * @details can be coalesced. Register reads / writes and interrupts alone are executed at once.
+    * @param tickUs microseconds (0 = execute the pin writes at once)
+    */
+   inline void setTick(uint32_t tickUs) { this->tickUs.store(tickUs); };
+
+   /**
+    * @ingroup group16
+    * @brief Checks if the service thread is running
+    */
+   inline bool isRunning() { return this->running.load(); };
+
+   /**
+    * @ingroup group16
+    * @brief Returns the number of requests executed
+    */
+   inline uint32_t getRequests() { return this->requests.load(); };
+
+   /**
+    * @ingroup group16
+    * @brief Returns the number of pin write requests executed
+    */
+   inline uint32_t getPinWrites() { return this->pinWrites.load(); };
+
+   /**
+    * @ingroup group16
+    * @brief Returns the number of OLAT writes done for the pin write requests (getPinWrites - getOlatWrites = writes saved by the coalescing)
+    */
+   inline uint32_t getOlatWrites() { return this->olatWrites.load(); };
+
+   /**
+    * @ingroup group16
+    * @brief Returns the number of interrupts serviced
+    */
+   inline uint32_t getInterrupts() { return this->interrupts.load(); };
+};
+
+#endif
+#endif // _PU2CLR_MCP23008_SERVICE_H
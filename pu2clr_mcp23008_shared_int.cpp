@@ -0,0 +1,109 @@
+/**
+ * @file pu2clr_mcp23008_shared_int.cpp
+ * @brief Dispatcher for many MCP23008 devices sharing one interrupt line - implementation
+ */
+
+#include "pu2clr_mcp23008_shared_int.h"
+
+/** @defgroup group05 MCP23008 shared interrupt line */
+
+/**
+ * @ingroup group05
+ * @brief Adds a device to the shared interrupt line
+ * @details Call it after the device setup.
+ * @param mcp the device
+ * @param openDrain if true, configures the device INT pin as open-drain (required to share the line)
+ * @return uint8_t device index used by attach and by the handlers (MCP_SHARED_INT_MAX_DEVICES if there is no room)
+ */
+uint8_t MCPSharedInterrupt::add(MCP *mcp, bool openDrain) {
+    uint8_t index = this->count;
+
+    if (index >= MCP_SHARED_INT_MAX_DEVICES)
+        return MCP_SHARED_INT_MAX_DEVICES;
+    if (openDrain)
+        mcp->setInterrupt(INTERRUPT_INTPOL_ACTIVE_LOW, INTERRUPT_ODR_OPEN_DRAIN);
+    this->devices[index] = mcp;
+    this->order[index] = index;
+    for (uint8_t gpio = 0; gpio < 8; gpio++)
+        this->handlers[index][gpio] = 0;
+    this->count++;
+    return index;
+}
+
+/**
+ * @ingroup group05
+ * @brief Sets the handler of a given pin of a given device
+ * @param device device index (see add)
+ * @param gpio pin (0 ~ 7)
+ * @param handler pin handler (0 removes it)
+ */
+void MCPSharedInterrupt::attach(uint8_t device, uint8_t gpio, MCPPinHandler handler) {
+    if (device >= this->count || gpio > 7)
+        return;
+    this->handlers[device][gpio] = handler;
+}
+
+/**
+ * @ingroup group05
+ * @brief Finds and services the devices that fired
+ * @details Reads INTF of each device, starting by the most recently active one. 
+ * @details A device that fired is cleared (INTCAP read), its pin handlers are called and it moves to the front of the service order.
+ * @details A device whose INTF or INTCAP read fails is skipped (no handler is called).
+ * @details If a line reader was set, the scan stops as soon as the line is released.
+ * @return uint8_t number of devices that fired
+ */
+uint8_t MCPSharedInterrupt::service() {
+    uint8_t fired = 0, index, intf, intcap;
+    MCP *mcp;
+
+    for (uint8_t k = 0; k < this->count; k++)
+    {
+        index = this->order[k];
+        mcp = this->devices[index];
+        if (mcp->readRegister(REG_INTF, &intf) != MCP_BUS_OK || intf == 0)
+            continue;  // a device that does not answer is skipped (getINTF would return 0xFF: all pins fired)
+        if (mcp->readRegister(REG_INTCAP, &intcap) != MCP_BUS_OK)
+            continue;  // clears the interrupt of this device only
+        fired++;
+
+        for (uint8_t gpio = 0; gpio < 8; gpio++)
+            if (CHECK_BIT_HIGH(intf, gpio) && this->handlers[index][gpio])
+                this->handlers[index][gpio](index, gpio, CHECK_BIT_HIGH(intcap, gpio) != 0);
+
+        // Move to front: the last active device is checked first next time
+        for (uint8_t j = k; j > 0; j--)
+            this->order[j] = this->order[j - 1];
+        this->order[0] = index;
+
+        if (this->lineReader && !this->lineReader())
+            break; // no other device is holding the line
+    }
+    return fired;
+}
+
+/**
+ * @ingroup group05
+ * @brief Services the signaled interrupt (see onInterrupt). Call it in the loop.
+ * @details The devices are scanned again while the line reader reports the line asserted (a device fired after its INTF was checked), 
+ * @details up to MCP_SHARED_INT_MAX_PASSES scans. If the line is still asserted, or if there is no line reader and a device fired, 
+ * @details the interrupt stays signaled and the next poll scans again.
+ * @return uint8_t number of devices that fired
+ */
+uint8_t MCPSharedInterrupt::poll() {
+    uint8_t fired = 0, passes = 0, found;
+
+    if (!this->pending)
+        return 0;
+    this->pending = false;
+
+    do
+    {
+        found = this->service();
+        fired += found;
+        passes++;
+    } while (this->lineReader && passes < MCP_SHARED_INT_MAX_PASSES && this->lineReader());
+
+    if (this->lineReader ? this->lineReader() : (found > 0))
+        this->pending = true;
+    return fired;
+}
@@ -0,0 +1,95 @@
+/**
+ * @file pu2clr_mcp23008_shared_int.h
+ * @brief Dispatcher for many MCP23008 devices sharing one interrupt line
+ * @details With the INT pins configured as open-drain (wire-OR), many devices can share a single MCU interrupt pin. 
+ * @details When the line is asserted, the dispatcher reads INTF of each device, starting by the most recently active one. 
+ * @details Only the devices that fired are cleared (INTCAP read) and their pin handlers are called. 
+ * @details If a line reader is provided, the scan stops as soon as the line is released (early exit).
+ * @details A device can fire after its INTF was checked. The line then stays asserted and no new (FALLING) edge arrives. So poll scans 
+ * @details again while the line reader reports the line asserted (up to MCP_SHARED_INT_MAX_PASSES scans; then the next poll goes on).
+ * @details Without a line reader, a scan that found a device is always followed by a new scan in the next poll.
+ * @code
+ *   MCP mcp[6];
+ *   MCPSharedInterrupt sharedInt;
+ *
+ *   bool intLineAsserted() { return digitalRead(2) == LOW; }
+ *   void isr() { sharedInt.onInterrupt(); }
+ *   void onPin(uint8_t device, uint8_t gpio, bool level) { ... }
+ *
+ *   void setup() {
+ *     for (uint8_t i = 0; i < 6; i++) {
+ *       mcp[i].setup(0x20 + i, GPIO_INPUT);
+ *       uint8_t d = sharedInt.add(&mcp[i]);   // INT pin as open-drain
+ *       sharedInt.attach(d, MCP_GPIO0, onPin);
+ *     }
+ *     sharedInt.setLineReader(intLineAsserted);
+ *     attachInterrupt(digitalPinToInterrupt(2), isr, FALLING);
+ *   }
+ *   void loop() { sharedInt.poll(); }
+ * @endcode
+ */
+
+#ifndef _PU2CLR_MCP23008_SHARED_INT_H
+#define _PU2CLR_MCP23008_SHARED_INT_H
+
+#include "pu2clr_mcp23008.h"
+
+#define MCP_SHARED_INT_MAX_DEVICES 8 //!< Maximum number of devices on the same interrupt line
+
+#ifndef MCP_SHARED_INT_MAX_PASSES
+#define MCP_SHARED_INT_MAX_PASSES 4  //!< Maximum number of scans per poll while the line stays asserted (see MCPSharedInterrupt::poll)
+#endif
+
+/**
+ * @brief Pin handler
+ * @param device device index (returned by MCPSharedInterrupt::add)
+ * @param gpio pin that caused the interrupt (0 ~ 7)
+ * @param level pin level captured by INTCAP
+ */
+typedef void (*MCPPinHandler)(uint8_t device, uint8_t gpio, bool level);
+
+/**
+ * @brief Returns true while the shared interrupt line is asserted
+ */
+typedef bool (*MCPIntLineReader)();
+
+/**
+ * @brief Dispatcher for many MCP23008 devices sharing one interrupt line
+ */
+class MCPSharedInterrupt
+{
+protected:
+   MCP *devices[MCP_SHARED_INT_MAX_DEVICES];
+   uint8_t order[MCP_SHARED_INT_MAX_DEVICES];  //!< service order (most recently active first)
+   uint8_t count = 0;
+   MCPPinHandler handlers[MCP_SHARED_INT_MAX_DEVICES][8];
+   MCPIntLineReader lineReader = 0;
+   volatile bool pending = false;
+
+public:
+   uint8_t add(MCP *mcp, bool openDrain = true);
+   void attach(uint8_t device, uint8_t gpio, MCPPinHandler handler);
+   uint8_t service();
+   uint8_t poll();
+
+   /**
+    * @ingroup group05
+    * @brief Sets the function that reads the shared interrupt line (enables the early exit)
+    * @param reader returns true while the line is asserted (0 = always scans all devices)
+    */
+   inline void setLineReader(MCPIntLineReader reader) { this->lineReader = reader; };
+
+   /**
+    * @ingroup group05
+    * @brief Signals an interrupt (ISR safe; no I2C traffic)
+    */
+   inline void onInterrupt() { this->pending = true; };
+
+   /**
+    * @ingroup group05
+    * @brief Returns the number of devices
+    */
+   inline uint8_t getCount() { return this->count; };
+};
+
+#endif // _PU2CLR_MCP23008_SHARED_INT_H
@@ -0,0 +1,368 @@
+/**
+ * @file pu2clr_mcp23008_sim.cpp
+ * @brief In-memory MCP23008 simulator implementation
+ * @details Based on the Datasheet "MCP23008 8-Bit I/O Expander with Serial Interface" from Microchip.
+ */
+
+#include "pu2clr_mcp23008_sim.h"
+
+/** @defgroup group10 MCP23008 simulator */
+
+/**
+ * @ingroup group10
+ * @brief Sets the Power-on Reset values
+ * @details IODIR = 0xFF (all pins input). All other registers = 0. The levels driven by the external circuit are kept.
+ */
+void MCPSimDevice::reset() {
+    memset(this->regs, 0, sizeof(this->regs));
+    this->regs[REG_IODIR] = 0xFF;
+    this->pointer = 0;
+    this->lastPort = this->getPort();
+}
+
+/**
+ * @ingroup group10
+ * @brief Returns the GPIO register value
+ * @details Input pins reflect the external levels (inverted if the IPOL bit is set). Output pins reflect the OLAT register.
+ * @return uint8_t
+ */
+uint8_t MCPSimDevice::getPort() {
+    uint8_t iodir = this->regs[REG_IODIR];
+    return (((this->inputs ^ this->regs[REG_IPOL]) & iodir) | (this->regs[REG_OLAT] & ~iodir));
+}
+
+/**
+ * @ingroup group10
+ * @brief Checks the interrupt-on-change condition
+ * @details Pins enabled via GPINTEN are compared against DEFVAL (INTCON bit set) or against the previous value (INTCON bit clear).
+ * @details While an interrupt is pending (INTF != 0), INTF and INTCAP are not changed.
+ */
+void MCPSimDevice::evaluateInterrupt() {
+    uint8_t port = this->getPort();
+    uint8_t intcon = this->regs[REG_INTCON];
+    uint8_t ref = (intcon & this->regs[REG_DEFVAL]) | (~intcon & this->lastPort);
+    uint8_t changed = (port ^ ref) & this->regs[REG_GPINTEN] & this->regs[REG_IODIR];
+
+    if (changed && this->regs[REG_INTF] == 0)
+    {
+        this->regs[REG_INTF] = changed;
+        this->regs[REG_INTCAP] = port;
+    }
+    this->lastPort = port;
+}
+
+/**
+ * @ingroup group10
+ * @brief Clears the interrupt condition (read of GPIO or INTCAP)
+ * @details If a pin compared against DEFVAL still differs from it, a new interrupt occurs immediately.
+ */
+void MCPSimDevice::clearInterrupt() {
+    uint8_t port = this->getPort();
+    uint8_t changed = (port ^ this->regs[REG_DEFVAL]) & this->regs[REG_INTCON] & this->regs[REG_GPINTEN] & this->regs[REG_IODIR];
+
+    this->regs[REG_INTF] = changed;
+    if (changed)
+        this->regs[REG_INTCAP] = port;
+    this->lastPort = port;
+}
+
+/**
+ * @ingroup group10
+ * @brief Sets the address pointer
+ * @param reg register
+ */
+void MCPSimDevice::setPointer(uint8_t reg) {
+    this->pointer = reg;
+}
+
+/**
+ * @ingroup group10
+ * @brief Reads the register pointed by the address pointer
+ * @details If the Sequential Operation is enabled (IOCON SEQOP = 0), the address pointer increments and rolls over to 0x00 after OLAT.
+ * @return uint8_t
+ */
+uint8_t MCPSimDevice::read() {
+    uint8_t value = this->readRegister(this->pointer);
+    if (!(this->regs[REG_IOCON] & IOCON_SEQOP) && this->pointer <= REG_OLAT)
+        this->pointer = (this->pointer + 1) % MCP_REG_COUNT;
+    return value;
+}
+
+/**
+ * @ingroup group10
+ * @brief Writes the register pointed by the address pointer
+ * @details If the Sequential Operation is enabled (IOCON SEQOP = 0), the address pointer increments and rolls over to 0x00 after OLAT.
+ * @param value
+ */
+void MCPSimDevice::write(uint8_t value) {
+    uint8_t seqop = this->regs[REG_IOCON] & IOCON_SEQOP; // a write to IOCON takes effect on the next byte
+    this->writeRegister(this->pointer, value);
+    if (!seqop && this->pointer <= REG_OLAT)
+        this->pointer = (this->pointer + 1) % MCP_REG_COUNT;
+}
+
+/**
+ * @ingroup group10
+ * @brief Reads a given register (with the device side effects)
+ * @details Reading GPIO or INTCAP clears the interrupt condition.
+ * @param reg register
+ * @return uint8_t
+ */
+uint8_t MCPSimDevice::readRegister(uint8_t reg) {
+    uint8_t value;
+
+    if (reg > REG_OLAT)
+        return 0;
+
+    value = this->peek(reg);
+    if (reg == REG_GPIO || reg == REG_INTCAP)
+        this->clearInterrupt();
+    return value;
+}
+
+/**
+ * @ingroup group10
+ * @brief Writes a given register
+ * @details Writing GPIO modifies OLAT. INTF and INTCAP are read-only.
+ * @param reg register
+ * @param value
+ */
+void MCPSimDevice::writeRegister(uint8_t reg, uint8_t value) {
+    switch (reg)
+    {
+    case REG_INTF:
+    case REG_INTCAP:
+        return;
+    case REG_GPIO:
+        reg = REG_OLAT;
+        break;
+    case REG_IOCON:
+        value &= 0B00111110;  // unimplemented bits read as 0
+        break;
+    default:
+        if (reg > REG_OLAT)
+            return;
+    }
+    this->regs[reg] = value;
+    this->evaluateInterrupt();
+}
+
+/**
+ * @ingroup group10
+ * @brief Sets the levels driven by the external circuit on the pins
+ * @details Only the pins configured as input (IODIR) are affected. It can launch an interrupt.
+ * @param levels bit mask (1 = high)
+ */
+void MCPSimDevice::setInputs(uint8_t levels) {
+    this->inputs = levels;
+    this->evaluateInterrupt();
+}
+
+/**
+ * @ingroup group10
+ * @brief Checks if there is a pending interrupt (INT output asserted)
+ * @return true if INTF != 0
+ */
+bool MCPSimDevice::isInterruptActive() {
+    return this->regs[REG_INTF] != 0;
+}
+
+/**
+ * @ingroup group10
+ * @brief Returns the electrical level of the INT pin
+ * @details Open-drain (IOCON ODR = 1): low when active; released (high, external pull-up) when not active.
+ * @details Active driver (ODR = 0): IOCON INTPOL sets the active level.
+ * @return true if the INT pin is high
+ */
+bool MCPSimDevice::getIntPinLevel() {
+    mcp23008_ioncon iocon;
+    iocon.raw = this->regs[REG_IOCON];
+    if (iocon.arg.ODR)
+        return !this->isInterruptActive();
+    return this->isInterruptActive() == (bool)iocon.arg.INTPOL;
+}
+
+/**
+ * @ingroup group10
+ * @brief Connects a simulated device to a given address
+ * @param address 0x20 ~ 0x27
+ * @param device the simulated device (0 disconnects it)
+ */
+void MCPSimulatedBus::attach(uint8_t address, MCPSimDevice *device) {
+    if (address >= 0x20 && address <= 0x27)
+        this->devices[address - 0x20] = device;
+}
+
+/**
+ * @ingroup group10
+ * @brief Returns the device connected to a given address
+ * @param address device address
+ * @return MCPSimDevice* (0 if there is no device at the address)
+ */
+MCPSimDevice *MCPSimulatedBus::getDevice(uint8_t address) {
+    if (address < 0x20 || address > 0x27)
+        return 0;
+    return this->devices[address - 0x20];
+}
+
+/**
+ * @ingroup group10
+ * @brief Checks if the current transfer must fail (see injectErrors)
+ */
+bool MCPSimulatedBus::fault() {
+    if (this->faults == 0)
+        return false;
+    this->faults--;
+    return true;
+}
+
+/**
+ * @ingroup group10
+ * @brief Checks if the simulated transfer latency (see setLatency) has not elapsed yet
+ */
+bool MCPSimulatedBus::isBusy() {
+    return this->latency && (uint32_t)(micros() - this->lastTransfer) < this->latency;
+}
+
+/**
+ * @ingroup group10
+ * @brief Checks if there is a device at a given address
+ */
+uint8_t MCPSimulatedBus::probe(uint8_t address) {
+    this->lastTransfer = micros();
+    return (this->getDevice(address)) ? MCP_BUS_OK : MCP_BUS_NACK_ADDRESS;
+}
+
+/**
+ * @ingroup group10
+ * @brief Moves the device address pointer to reg and writes n bytes
+ */
+uint8_t MCPSimulatedBus::writeRegisters(uint8_t address, uint8_t reg, const uint8_t *data, uint8_t n) {
+    MCPSimDevice *device = this->getDevice(address);
+    this->lastTransfer = micros();
+    if (!device)
+        return MCP_BUS_NACK_ADDRESS;
+    if (this->fault())
+        return this->faultStatus;
+    device->setPointer(reg);
+    for (uint8_t i = 0; i < n; i++)
+        device->write(data[i]);
+    return MCP_BUS_OK;
+}
+
+/**
+ * @ingroup group10
+ * @brief Moves the device address pointer to reg and reads n bytes
+ */
+uint8_t MCPSimulatedBus::readRegisters(uint8_t address, uint8_t reg, uint8_t *data, uint8_t n) {
+    MCPSimDevice *device = this->getDevice(address);
+    this->lastTransfer = micros();
+    if (!device)
+        return MCP_BUS_NACK_ADDRESS;
+    if (this->fault())
+        return this->faultStatus;
+    device->setPointer(reg);
+    return MCPSimulatedBus::readCurrent(address, data, n);
+}
+
+/**
+ * @ingroup group10
+ * @brief Reads n bytes from the current device address pointer
+ */
+uint8_t MCPSimulatedBus::readCurrent(uint8_t address, uint8_t *data, uint8_t n) {
+    MCPSimDevice *device = this->getDevice(address);
+    this->lastTransfer = micros();
+    if (!device)
+        return MCP_BUS_NACK_ADDRESS;
+    if (this->fault())
+        return this->faultStatus;
+    for (uint8_t i = 0; i < n; i++)
+        data[i] = device->read();
+    return MCP_BUS_OK;
+}
+
+/**
+ * @ingroup group10
+ * @brief Connects a simulated device to the chip select
+ * @param hw hardware address of the device (A1 A0 pins: 0 ~ 3)
+ * @param device the simulated device
+ */
+void MCPSimSpiPort::attach(uint8_t hw, MCPSimDevice *device) {
+    if (hw < MCP_SPI_MAX_DEVICES)
+        this->devices[hw] = device;
+}
+
+/**
+ * @ingroup group10
+ * @brief Checks if a device answers to the opcode of the current frame
+ * @param hw hardware address of the device (A1 A0 pins)
+ */
+bool MCPSimSpiPort::answers(uint8_t hw) {
+    uint8_t target = (this->opcode >> 1) & 0x03;
+
+    if (!this->devices[hw] || (this->opcode & 0xF8) != MCP_SPI_OPCODE)
+        return false;
+    if (this->devices[hw]->peek(REG_IOCON) & IOCON_HAEN)
+        return target == hw;
+    return target == 0;  // address pins disabled
+}
+
+/**
+ * @ingroup group10
+ * @brief Starts a frame (chip select low)
+ */
+void MCPSimSpiPort::select() {
+    this->selected = true;
+    this->count = 0;
+}
+
+/**
+ * @ingroup group10
+ * @brief Decodes one byte of the frame: opcode, register address, then data
+ * @param value byte sent (MOSI)
+ * @return uint8_t byte received (MISO)
+ */
+uint8_t MCPSimSpiPort::transfer(uint8_t value) {
+    uint8_t result = this->idle;
+    bool driven = false;
+
+    if (!this->selected)
+        return result;
+    if (this->count == 0)
+    {   // the devices that answer are selected by the opcode (a HAEN change takes effect on the next frame)
+        this->opcode = value;
+        this->listeners = 0;
+        for (uint8_t hw = 0; hw < MCP_SPI_MAX_DEVICES; hw++)
+            if (this->answers(hw))
+                this->listeners |= 1 << hw;
+        this->count++;
+        return result;
+    }
+    for (uint8_t hw = 0; hw < MCP_SPI_MAX_DEVICES; hw++)
+    {
+        if (!CHECK_BIT_HIGH(this->listeners, hw))
+            continue;
+        if (this->count == 1)
+            this->devices[hw]->setPointer(value);
+        else if (this->opcode & MCP_SPI_READ)
+        {
+            uint8_t aux = this->devices[hw]->read();
+            if (!driven)
+                result = aux;
+            driven = true;
+        }
+        else
+            this->devices[hw]->write(value);
+    }
+    if (this->count < 2)
+        this->count++;
+    return result;
+}
+
+/**
+ * @ingroup group10
+ * @brief Ends a frame (chip select high)
+ */
+void MCPSimSpiPort::deselect() {
+    this->selected = false;
+}
@@ -0,0 +1,155 @@
+/**
+ * @file pu2clr_mcp23008_sim.h
+ * @brief In-memory MCP23008 simulator
+ * @details MCPSimDevice models the MCP23008 registers, the address pointer (including the SEQOP auto-increment) and the interrupt-on-change logic.
+ * @details MCPSimulatedBus is a MCPBus implementation that talks to up to 8 simulated devices (addresses 0x20 ~ 0x27).
+ * @details MCPSimSpiPort is a MCPSpiPort that decodes the MCP23S08 SPI frames for up to 4 simulated devices on one chip select (see MCPSpiBus).
+ * @details With them, the MCP class (and everything built on it) can be run and checked on a Linux host or on an Arduino board without the device.
+ * @code
+ *   MCPSimDevice chip;
+ *   MCPSimulatedBus simBus;
+ *   MCP mcp;
+ *
+ *   simBus.attach(0x20, &chip);
+ *   mcp.setBus(&simBus);
+ *   mcp.setup(0x20, 0B00001111);   // GPIO 0 ~ 3 input; 4 ~ 7 output
+ *   chip.setInputs(0B00000101);    // external levels on the input pins
+ *   mcp.gpioRead(MCP_GPIO2);        // true
+ * @endcode
+ */
+
+#ifndef _PU2CLR_MCP23008_SIM_H
+#define _PU2CLR_MCP23008_SIM_H
+
+#include "pu2clr_mcp23008.h"
+#include "pu2clr_mcp23008_spi.h"
+
+/**
+ * @brief Register level model of one MCP23008
+ */
+class MCPSimDevice
+{
+protected:
+   uint8_t regs[MCP_REG_COUNT]; //!< register content (the GPIO entry is computed by getPort)
+   uint8_t pointer = 0;         //!< address pointer
+   uint8_t inputs = 0;          //!< levels driven by the external circuit on the pins
+   uint8_t lastPort = 0;        //!< GPIO value in the last interrupt evaluation (INTCON = 0)
+
+   void evaluateInterrupt();
+   void clearInterrupt();
+
+public:
+   MCPSimDevice() { this->reset(); };
+   void reset();
+   void setPointer(uint8_t reg);
+   uint8_t read();
+   void write(uint8_t value);
+   uint8_t readRegister(uint8_t reg);
+   void writeRegister(uint8_t reg, uint8_t value);
+   void setInputs(uint8_t levels);
+   uint8_t getPort();
+   bool isInterruptActive();
+   bool getIntPinLevel();
+
+   /**
+    * @brief Returns a register content without side effects (reading GPIO or INTCAP on the device clears the interrupt)
+    * @param reg register
+    * @return uint8_t
+    */
+   inline uint8_t peek(uint8_t reg) { return (reg == REG_GPIO) ? this->getPort() : this->regs[reg]; };
+
+   /**
+    * @brief Returns the current address pointer
+    */
+   inline uint8_t getPointer() { return this->pointer; };
+
+   /**
+    * @brief Returns the levels driven by the external circuit
+    */
+   inline uint8_t getInputs() { return this->inputs; };
+};
+
+/**
+ * @brief MCPBus implementation that talks to simulated MCP23008 devices
+ */
+class MCPSimulatedBus : public MCPBus
+{
+protected:
+   MCPSimDevice *devices[8] = {0, 0, 0, 0, 0, 0, 0, 0}; //!< devices at 0x20 ~ 0x27
+   uint32_t latency = 0;       //!< us the bus stays busy after each transfer (see setLatency)
+   uint32_t lastTransfer = 0;  //!< micros() at the last transfer
+   uint8_t faults = 0;         //!< number of next transfers that will fail (see injectErrors)
+   uint8_t faultStatus = MCP_BUS_NACK_DATA; //!< status of the failed transfers
+
+   MCPSimDevice *getDevice(uint8_t address);
+   bool fault();
+
+public:
+   void attach(uint8_t address, MCPSimDevice *device);
+   bool isBusy();
+
+   /**
+    * @brief Sets the simulated transfer latency
+    * @details After each transfer, isBusy returns true for the given time (models a background transport: DMA, interrupt driven I2C etc).
+    * @details The transfers are still executed at once. Only the asynchronous users (MCPAsync) wait for the bus.
+    * @param us latency in microseconds (0 = never busy)
+    */
+   inline void setLatency(uint32_t us) { this->latency = us; };
+
+   /**
+    * @brief Makes the next transfers fail (bus noise, EMI etc)
+    * @details The failed transfers do not reach the device. Useful to test the retry policy and the error statistics (see MCP::setRetryPolicy).
+    * @param count number of next transfers (write, read or read current) that will fail
+    * @param status bus status returned by the failed transfers
+    */
+   inline void injectErrors(uint8_t count, uint8_t status = MCP_BUS_NACK_DATA)
+   {
+      this->faults = count;
+      this->faultStatus = status;
+   };
+   uint8_t probe(uint8_t address);
+   uint8_t writeRegisters(uint8_t address, uint8_t reg, const uint8_t *data, uint8_t n);
+   uint8_t readRegisters(uint8_t address, uint8_t reg, uint8_t *data, uint8_t n);
+   uint8_t readCurrent(uint8_t address, uint8_t *data, uint8_t n);
+};
+
+/**
+ * @brief MCPSpiPort implementation that decodes the MCP23S08 frames for simulated devices (one chip select)
+ * @details A device answers to the opcode if IOCON HAEN = 1 and A1 A0 match its pins, or if HAEN = 0 and A1 A0 = 00.
+ * @details Writes reach all devices that answer. On reads, the first device that answers drives MISO (the idle level if none; see setIdleLevel).
+ * @code
+ *   MCPSimDevice chip0, chip1;
+ *   MCPSimSpiPort port;
+ *   MCPSpiBus spiBus(&port);
+ *
+ *   port.attach(0, &chip0);    // A1 A0 = 00
+ *   port.attach(1, &chip1);    // A1 A0 = 01
+ *   spiBus.enableHardwareAddress();
+ * @endcode
+ */
+class MCPSimSpiPort : public MCPSpiPort
+{
+protected:
+   MCPSimDevice *devices[MCP_SPI_MAX_DEVICES] = {0, 0, 0, 0}; //!< devices by hardware address (A1 A0)
+   bool selected = false;  //!< chip select low
+   uint8_t count = 0;      //!< bytes of the current frame
+   uint8_t opcode = 0;     //!< opcode of the current frame
+   uint8_t listeners = 0;  //!< devices that answer to the current frame (bit n = A1 A0 = n)
+   uint8_t idle = 0xFF;    //!< MISO level when no device drives it
+
+   bool answers(uint8_t hw);
+
+public:
+   void attach(uint8_t hw, MCPSimDevice *device);
+
+   /**
+    * @brief Sets the byte read when no device drives MISO
+    * @param value 0xFF = pulled up or floating high (default); 0x00 = floating low
+    */
+   inline void setIdleLevel(uint8_t value) { this->idle = value; };
+   void select();
+   uint8_t transfer(uint8_t value);
+   void deselect();
+};
+
+#endif // _PU2CLR_MCP23008_SIM_H
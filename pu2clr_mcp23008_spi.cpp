@@ -0,0 +1,195 @@
+/**
+ * @file pu2clr_mcp23008_spi.cpp
+ * @brief MCP23S08 (SPI) transport implementation
+ */
+
+#include "pu2clr_mcp23008_spi.h"
+
+/** @defgroup group15 MCP23S08 SPI transport */
+
+#if defined(ARDUINO)
+
+/**
+ * @ingroup group15
+ * @brief Starts the SPI object (only once) and sets the chip select pin high
+ */
+void MCPArduinoSpiPort::begin() {
+    if (this->started)
+        return;
+    pinMode(this->csPin, OUTPUT);
+    digitalWrite(this->csPin, HIGH);
+    this->spi->begin();
+    this->started = true;
+}
+
+/**
+ * @ingroup group15
+ * @brief Sets the SPI clock (up to 10MHz on the MCP23S08)
+ * @param freq frequency in Hz
+ */
+void MCPArduinoSpiPort::setClock(long freq) {
+    this->settings = SPISettings(freq, MSBFIRST, SPI_MODE0);
+}
+
+/**
+ * @ingroup group15
+ * @brief Starts a SPI transaction and sets the chip select low
+ */
+void MCPArduinoSpiPort::select() {
+    this->spi->beginTransaction(this->settings);
+    digitalWrite(this->csPin, LOW);
+}
+
+/**
+ * @ingroup group15
+ * @brief Sends and receives one byte
+ */
+uint8_t MCPArduinoSpiPort::transfer(uint8_t value) {
+    return this->spi->transfer(value);
+}
+
+/**
+ * @ingroup group15
+ * @brief Sets the chip select high and ends the SPI transaction
+ */
+void MCPArduinoSpiPort::deselect() {
+    digitalWrite(this->csPin, HIGH);
+    this->spi->endTransaction();
+}
+
+#endif
+
+/**
+ * @ingroup group15
+ * @brief Starts the SPI port
+ */
+void MCPSpiBus::begin() {
+    this->port->begin();
+}
+
+/**
+ * @ingroup group15
+ * @brief Sets the SPI clock
+ * @param freq frequency in Hz (up to 10000000)
+ */
+void MCPSpiBus::setClock(long freq) {
+    this->port->setClock(freq);
+}
+
+/**
+ * @ingroup group15
+ * @brief Starts a frame: opcode (0B01000 A1 A0 R/W) and register address
+ * @param address device address (0x20 ~ 0x23)
+ * @param rw MCP_SPI_READ or 0 (write)
+ * @param reg register address
+ * @return uint8_t MCP_BUS_NACK_ADDRESS if the address is out of range (the frame is not started)
+ */
+uint8_t MCPSpiBus::start(uint8_t address, uint8_t rw, uint8_t reg) {
+    uint8_t hw = address - 0x20;
+
+    if (address < 0x20 || hw >= MCP_SPI_MAX_DEVICES)
+        return MCP_BUS_NACK_ADDRESS;
+    this->pointer[hw] = reg;
+    this->port->select();
+    this->port->transfer(MCP_SPI_OPCODE | (hw << 1) | rw);
+    this->port->transfer(reg);
+    return MCP_BUS_OK;
+}
+
+/**
+ * @ingroup group15
+ * @brief Checks if there is a device at a given address
+ * @details SPI has no acknowledge. The IOCON register is read: its bits 0, 6 and 7 are unimplemented and read as 0.
+ * @details A missing device with MISO pulled up or floating high reads 0xFF.
+ * @details A missing device with MISO floating low reads 0x00, which is also the IOCON reset value. In this case the DISSLW bit 
+ * @details (no function on the MCP23S08: there is no SDA pin) is set and read back, then IOCON is written back to 0x00.
+ * @param address device address (0x20 ~ 0x23)
+ * @return uint8_t MCP_BUS_OK if the device answers
+ */
+uint8_t MCPSpiBus::probe(uint8_t address) {
+    uint8_t iocon, check = IOCON_DISSLW;
+    uint8_t status = this->readRegisters(address, REG_IOCON, &iocon, 1);
+
+    if (status != MCP_BUS_OK)
+        return status;
+    if (iocon & 0xC1)
+        return MCP_BUS_NACK_ADDRESS;
+    if (iocon != 0)
+        return MCP_BUS_OK;
+
+    this->writeRegisters(address, REG_IOCON, &check, 1);
+    this->readRegisters(address, REG_IOCON, &check, 1);
+    this->writeRegisters(address, REG_IOCON, &iocon, 1);
+    return (check == IOCON_DISSLW) ? MCP_BUS_OK : MCP_BUS_NACK_ADDRESS;
+}
+
+/**
+ * @ingroup group15
+ * @brief Writes n bytes starting at a given register in a single SPI frame
+ * @param address device address (0x20 ~ 0x23)
+ * @param reg first register
+ * @param data values
+ * @param n number of bytes
+ * @return uint8_t bus status
+ */
+uint8_t MCPSpiBus::writeRegisters(uint8_t address, uint8_t reg, const uint8_t *data, uint8_t n) {
+    uint8_t status = this->start(address, 0, reg);
+
+    if (status != MCP_BUS_OK)
+        return status;
+    for (uint8_t i = 0; i < n; i++)
+        this->port->transfer(data[i]);
+    this->port->deselect();
+    return MCP_BUS_OK;
+}
+
+/**
+ * @ingroup group15
+ * @brief Reads n bytes starting at a given register in a single SPI frame
+ * @param address device address (0x20 ~ 0x23)
+ * @param reg first register
+ * @param data buffer
+ * @param n number of bytes
+ * @return uint8_t bus status
+ */
+uint8_t MCPSpiBus::readRegisters(uint8_t address, uint8_t reg, uint8_t *data, uint8_t n) {
+    uint8_t status = this->start(address, MCP_SPI_READ, reg);
+
+    if (status != MCP_BUS_OK)
+        return status;
+    for (uint8_t i = 0; i < n; i++)
+        data[i] = this->port->transfer(0);
+    this->port->deselect();
+    return MCP_BUS_OK;
+}
+
+/**
+ * @ingroup group15
+ * @brief Reads n bytes from the register of the last frame
+ * @details A SPI read frame always carries the register address (there is no bare read). The register of the last frame sent to the device is used.
+ * @details It is the behavior the GPIO stream mode expects (MCP::beginGpioStream: SEQOP = 1 and the address pointer parked on GPIO).
+ * @param address device address (0x20 ~ 0x23)
+ * @param data buffer
+ * @param n number of bytes
+ * @return uint8_t bus status
+ */
+uint8_t MCPSpiBus::readCurrent(uint8_t address, uint8_t *data, uint8_t n) {
+    if (address < 0x20 || address - 0x20 >= MCP_SPI_MAX_DEVICES)
+        return MCP_BUS_NACK_ADDRESS;
+    return this->readRegisters(address, this->pointer[address - 0x20], data, n);
+}
+
+/**
+ * @ingroup group15
+ * @brief Enables the hardware address pins (IOCON HAEN) of all devices on the chip select
+ * @details While HAEN = 0 (power on), every device answers to A1 A0 = 00. So a single IOCON write to A1 A0 = 00 reaches all devices
+ * @details at the same time. After that, each device answers only to the address set on its A1 and A0 pins.
+ * @details Call it before MCP::setup. Keep the HAEN bit set if you change IOCON (see MCP::setIoCon).
+ * @param iocon IOCON value written together with HAEN (default 0)
+ */
+void MCPSpiBus::enableHardwareAddress(uint8_t iocon) {
+    uint8_t value = iocon | IOCON_HAEN;
+
+    this->port->begin();
+    this->writeRegisters(0x20, REG_IOCON, &value, 1);
+}
@@ -0,0 +1,128 @@
+/**
+ * @file pu2clr_mcp23008_spi.h
+ * @brief MCP23S08 (SPI) transport
+ * @details MCPSpiBus is a MCPBus implementation for the MCP23S08, the SPI version of the MCP23008 (same registers, up to 10MHz).
+ * @details Each SPI frame is: opcode (0B01000 A1 A0 R/W), register address and the data bytes. The sequential reads and writes use the
+ * @details same address pointer auto-increment (IOCON SEQOP) of the MCP23008. So the MCP class (and everything built on it) runs unchanged.
+ * @details The device address passed to MCP::setup is 0x20 ~ 0x23 (A1 A0 = address - 0x20).
+ * @details Up to four MCP23S08 can share one chip select. At power on the address pins are disabled (IOCON HAEN = 0) and all the devices answer
+ * @details to A1 A0 = 00. Call enableHardwareAddress once (before MCP::setup): it sets HAEN on all devices of the chip select at the same time.
+ * @details The SPI signals are handled by a MCPSpiPort: MCPArduinoSpiPort (Arduino SPI) or MCPSimSpiPort (simulated devices; see pu2clr_mcp23008_sim.h).
+ * @code
+ *   MCPArduinoSpiPort port(10);     // chip select on Arduino pin 10
+ *   MCPSpiBus spiBus(&port);
+ *   MCP mcp0, mcp1;
+ *
+ *   spiBus.enableHardwareAddress();
+ *   mcp0.setBus(&spiBus);
+ *   mcp0.setup(0x20, GPIO_OUTPUT, -1, 10000000);   // A1 A0 = 00; SPI clock 10MHz
+ *   mcp1.setBus(&spiBus);
+ *   mcp1.setup(0x21, GPIO_INPUT, -1, 10000000);    // A1 A0 = 01
+ * @endcode
+ */
+
+#ifndef _PU2CLR_MCP23008_SPI_H
+#define _PU2CLR_MCP23008_SPI_H
+
+#include "pu2clr_mcp23008.h"
+
+#if defined(ARDUINO)
+#include <SPI.h>
+#endif
+
+#define MCP_SPI_OPCODE 0x40        //!< MCP23S08 opcode (0B01000 A1 A0 R/W)
+#define MCP_SPI_READ 0x01          //!< R/W bit of the opcode: 1 = read
+#define MCP_SPI_MAX_DEVICES 4      //!< devices per chip select (A1 A0)
+
+#ifndef MCP_SPI_CLOCK
+#define MCP_SPI_CLOCK 1000000      //!< Default SPI clock (Hz) until MCP::setup sets the clock. The MCP23S08 supports up to 10MHz.
+#endif
+
+/**
+ * @brief SPI signals used by MCPSpiBus (one chip select)
+ * @details select / deselect drive the chip select. transfer sends one byte (MOSI) and returns the byte received at the same time (MISO).
+ */
+class MCPSpiPort
+{
+public:
+   /**
+    * @brief Starts the SPI port
+    */
+   virtual void begin() {};
+
+   /**
+    * @brief Sets the SPI clock
+    * @param freq frequency in Hz
+    */
+   virtual void setClock(long freq) { (void) freq; };
+
+   /**
+    * @brief Starts a frame (chip select low)
+    */
+   virtual void select() = 0;
+
+   /**
+    * @brief Sends and receives one byte
+    * @param value byte sent
+    * @return uint8_t byte received
+    */
+   virtual uint8_t transfer(uint8_t value) = 0;
+
+   /**
+    * @brief Ends a frame (chip select high)
+    */
+   virtual void deselect() = 0;
+
+   virtual ~MCPSpiPort() {};
+};
+
+#if defined(ARDUINO)
+/**
+ * @brief MCPSpiPort implementation based on the Arduino SPI object (SPI mode 0, MSB first)
+ */
+class MCPArduinoSpiPort : public MCPSpiPort
+{
+protected:
+   SPIClass *spi;
+   uint8_t csPin;          //!< Arduino pin connected to the MCP23S08 CS
+   SPISettings settings = SPISettings(MCP_SPI_CLOCK, MSBFIRST, SPI_MODE0);
+   bool started = false;
+
+public:
+   MCPArduinoSpiPort(uint8_t csPin, SPIClass *spi = &SPI) : spi(spi), csPin(csPin) {};
+   void begin();
+   void setClock(long freq);
+   void select();
+   uint8_t transfer(uint8_t value);
+   void deselect();
+};
+#endif
+
+/**
+ * @brief MCPBus implementation for the MCP23S08 (SPI)
+ */
+class MCPSpiBus : public MCPBus
+{
+protected:
+   MCPSpiPort *port;
+   uint8_t pointer[MCP_SPI_MAX_DEVICES] = {0, 0, 0, 0}; //!< register address of the last frame of each device (see readCurrent)
+
+   uint8_t start(uint8_t address, uint8_t rw, uint8_t reg);
+
+public:
+   MCPSpiBus(MCPSpiPort *port) : port(port) {};
+   void begin();
+   void setClock(long freq);
+   uint8_t probe(uint8_t address);
+   uint8_t writeRegisters(uint8_t address, uint8_t reg, const uint8_t *data, uint8_t n);
+   uint8_t readRegisters(uint8_t address, uint8_t reg, uint8_t *data, uint8_t n);
+   uint8_t readCurrent(uint8_t address, uint8_t *data, uint8_t n);
+   void enableHardwareAddress(uint8_t iocon = 0);
+
+   /**
+    * @brief Returns the SPI port
+    */
+   inline MCPSpiPort *getPort() { return this->port; };
+};
+
+#endif // _PU2CLR_MCP23008_SPI_H
@@ -0,0 +1,222 @@
+/**
+ * @file pu2clr_mcp23008_static.h
+ * @brief Compile-time specialized MCP23008 driver
+ * @details MCP23008<Addr, Bus> is a header only variant of the MCP class for tight loops on small MCUs (AVR).
+ * @details The device address and the transport type are template parameters. Pins are template arguments, so the
+ * @details masks are computed and the range checks are done at compile time (static_assert), and the transport calls
+ * @details are bound statically (no virtual call). Pin groups are constexpr bit masks built by MCPPins.
+ * @details The output latch is kept in a shadow register. A multi-pin update is folded to a single precomputed OLAT write,
+ * @details and nothing is sent if the value does not change.
+ * @details Bus must be a concrete transport class (MCPWireBus, MCPSimulatedBus, MCPLinuxI2CBus etc) or any class with the same methods.
+ * @code
+ *   MCPWireBus wireBus;
+ *   MCP23008<0x20, MCPWireBus> mcp(wireBus);
+ *
+ *   typedef MCPPins<MCP_GPIO0, MCP_GPIO2, MCP_GPIO6> Leds;   // constexpr mask: 0B01000101
+ *
+ *   void setup() { mcp.setup(GPIO_OUTPUT); }
+ *   void loop() {
+ *     mcp.turnOn<MCP_GPIO1>();
+ *     mcp.update<Leds::mask, MCPPins<MCP_GPIO1>::mask>();   // one I2C write: pins 0, 2 and 6 on; pin 1 off
+ *     // mcp.turnOn<8>();                                     // does not compile
+ *   }
+ * @endcode
+ */
+
+#ifndef _PU2CLR_MCP23008_STATIC_H
+#define _PU2CLR_MCP23008_STATIC_H
+
+#include "pu2clr_mcp23008.h"
+
+/**
+ * @brief Compile-time pin group
+ * @details MCPPins<0, 3, 5>::mask is 0B00101001. Pins out of the range 0 ~ 7 do not compile.
+ */
+template <uint8_t... Pins>
+struct MCPPins;
+
+template <>
+struct MCPPins<>
+{
+   static constexpr uint8_t mask = 0;
+};
+
+template <uint8_t Pin, uint8_t... Rest>
+struct MCPPins<Pin, Rest...>
+{
+   static_assert(Pin < 8, "MCP23008 pin must be 0 ~ 7");
+   static constexpr uint8_t mask = (uint8_t)((1 << Pin) | MCPPins<Rest...>::mask);
+};
+
+/**
+ * @brief Compile-time specialized MCP23008 driver
+ * @tparam Addr device address (0x20 ~ 0x27)
+ * @tparam Bus concrete transport class
+ */
+template <uint8_t Addr, class Bus>
+class MCP23008
+{
+   static_assert(Addr >= 0x20 && Addr <= 0x27, "MCP23008 address must be 0x20 ~ 0x27");
+
+protected:
+   Bus &bus;
+   uint8_t olat = 0;  //!< OLAT shadow register
+   uint8_t gppu = 0;  //!< GPPU shadow register
+
+   inline void write(uint8_t reg, uint8_t value) { this->bus.Bus::writeRegisters(Addr, reg, &value, 1); }; // static dispatch
+
+public:
+   MCP23008(Bus &bus) : bus(bus){};
+
+   /**
+    * @brief Starts the device
+    * @details The GPPU shadow register is loaded from the device: after a reset of the MCU only, the pull ups still set on the device are kept by pullUpOn.
+    * @param io IODIR value (GPIO_OUTPUT, GPIO_INPUT or a bit mask)
+    */
+   inline void setup(uint8_t io = GPIO_OUTPUT)
+   {
+      uint8_t value;
+
+      this->bus.Bus::begin();
+      if (this->bus.Bus::readRegisters(Addr, REG_GPPU, &value, 1) == MCP_BUS_OK)
+         this->gppu = value;
+      this->write(REG_IODIR, io);
+      this->olat = 0;
+      this->write(REG_OLAT, 0);
+   };
+
+   /**
+    * @brief Sets the pins of SetMask high and the pins of ClearMask low in a single write
+    * @details The new OLAT value is computed from the shadow register; nothing is sent if it does not change.
+    * @tparam SetMask pins to turn on (Example: MCPPins<0, 1>::mask)
+    * @tparam ClearMask pins to turn off
+    */
+   template <uint8_t SetMask, uint8_t ClearMask = 0>
+   inline void update()
+   {
+      static_assert((SetMask & ClearMask) == 0, "a pin cannot be set and cleared at the same time");
+      uint8_t value = (uint8_t)((this->olat | SetMask) & ~ClearMask);
+      if (value != this->olat)
+      {
+         this->olat = value;
+         this->write(REG_OLAT, value);
+      }
+   };
+
+   /**
+    * @brief Turns a given pin on (high level)
+    * @tparam Pin 0 ~ 7
+    */
+   template <uint8_t Pin>
+   inline void turnOn() { this->update<MCPPins<Pin>::mask, 0>(); };
+
+   /**
+    * @brief Turns a given pin off (low level)
+    * @tparam Pin 0 ~ 7
+    */
+   template <uint8_t Pin>
+   inline void turnOff() { this->update<0, MCPPins<Pin>::mask>(); };
+
+   /**
+    * @brief Writes a given pin
+    * @tparam Pin 0 ~ 7
+    * @param value HIGH or LOW
+    */
+   template <uint8_t Pin>
+   inline void pinWrite(uint8_t value)
+   {
+      if (value)
+         this->turnOn<Pin>();
+      else
+         this->turnOff<Pin>();
+   };
+
+   /**
+    * @brief Writes the pins of a group
+    * @tparam Mask pin group (Example: MCPPins<4, 5, 6, 7>::mask)
+    * @param value bit values (bits out of Mask are ignored)
+    */
+   template <uint8_t Mask>
+   inline void writePins(uint8_t value)
+   {
+      value = (uint8_t)((this->olat & ~Mask) | (value & Mask));
+      if (value != this->olat)
+      {
+         this->olat = value;
+         this->write(REG_OLAT, value);
+      }
+   };
+
+   /**
+    * @brief Reads the pins of a group
+    * @tparam Mask pin group
+    * @return uint8_t GPIO & Mask
+    */
+   template <uint8_t Mask>
+   inline uint8_t readPins() { return this->getGPIOS() & Mask; };
+
+   /**
+    * @brief Reads a given pin
+    * @tparam Pin 0 ~ 7
+    * @return true if the pin is high
+    */
+   template <uint8_t Pin>
+   inline bool pinRead() { return this->readPins<MCPPins<Pin>::mask>() != 0; };
+
+   /**
+    * @brief Enables the internal pull up resistors of a group (the other pins are not changed)
+    * @tparam Mask pin group
+    */
+   template <uint8_t Mask>
+   inline void pullUpOn()
+   {
+      this->gppu |= Mask;
+      this->write(REG_GPPU, this->gppu);
+   };
+
+   /**
+    * @brief Sets the pin directions
+    * @tparam InputMask pins configured as input (the other ones are output)
+    */
+   template <uint8_t InputMask>
+   inline void setDirection() { this->write(REG_IODIR, InputMask); };
+
+   /**
+    * @brief Returns the GPIO register
+    */
+   inline uint8_t getGPIOS()
+   {
+      uint8_t value = 0xFF;
+      this->bus.Bus::readRegisters(Addr, REG_GPIO, &value, 1);
+      return value;
+   };
+
+   /**
+    * @brief Returns the output latch (shadow register; no I2C traffic)
+    */
+   inline uint8_t getOutputs() { return this->olat; };
+
+   /**
+    * @brief Sets a value to a given register (primitive)
+    */
+   inline void setRegister(uint8_t reg, uint8_t value)
+   {
+      if (reg == REG_GPIO || reg == REG_OLAT)
+         this->olat = value;
+      else if (reg == REG_GPPU)
+         this->gppu = value;
+      this->write(reg, value);
+   };
+
+   /**
+    * @brief Gets a given register (primitive)
+    */
+   inline uint8_t getRegister(uint8_t reg)
+   {
+      uint8_t value = 0xFF;
+      this->bus.Bus::readRegisters(Addr, reg, &value, 1);
+      return value;
+   };
+};
+
+#endif // _PU2CLR_MCP23008_STATIC_H